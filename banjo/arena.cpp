@@ -0,0 +1,96 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "arena.hpp"
+
+#include <cstdint>
+
+
+namespace banjo
+{
+
+namespace
+{
+
+// Returns p rounded up to the next multiple of a, which must be a
+// power of two.
+inline char*
+align_up(char* p, std::size_t a)
+{
+  std::uintptr_t n = reinterpret_cast<std::uintptr_t>(p);
+  return reinterpret_cast<char*>((n + a - 1) & ~(std::uintptr_t(a) - 1));
+}
+
+
+} // namespace
+
+
+Arena::Arena()
+  : first(nullptr), last(nullptr), head(nullptr)
+  , count(0), used(0), total(0), nblocks(0)
+{ }
+
+
+// Destroy all registered objects in the reverse order of their
+// construction, and then release each block.
+Arena::~Arena()
+{
+  for (auto i = dtors.rbegin(); i != dtors.rend(); ++i)
+    i->fn(i->obj);
+  while (head) {
+    Block* b = head;
+    head = head->next;
+    ::operator delete(b);
+  }
+}
+
+
+// Allocate n bytes with alignment a.
+void*
+Arena::allocate(std::size_t n, std::size_t a)
+{
+  used += n;
+#ifndef BANJO_HEAP_ALLOCATION
+  char* p = align_up(first, a);
+  if (first && p + n <= last) {
+    first = p + n;
+    return p;
+  }
+#endif
+  return allocate_block(n, a);
+}
+
+
+// Allocate a new block that can accommodate at least n bytes with
+// alignment a. Small requests start a new current block; large
+// requests get a dedicated block, leaving the current block intact.
+void*
+Arena::allocate_block(std::size_t n, std::size_t a)
+{
+  std::size_t need = sizeof(Block) + a + n;
+  std::size_t size = need;
+#ifndef BANJO_HEAP_ALLOCATION
+  bool large = n > block_size / 4;
+  if (!large)
+    size = block_size;
+#endif
+
+  Block* b = static_cast<Block*>(::operator new(size));
+  b->next = head;
+  head = b;
+  total += size;
+  ++nblocks;
+
+  char* base = reinterpret_cast<char*>(b + 1);
+  char* p = align_up(base, a);
+#ifndef BANJO_HEAP_ALLOCATION
+  if (!large) {
+    first = p + n;
+    last = reinterpret_cast<char*>(b) + size;
+  }
+#endif
+  return p;
+}
+
+
+} // namespace banjo
@@ -0,0 +1,107 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_ARENA_HPP
+#define BANJO_ARENA_HPP
+
+#include "prelude.hpp"
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+
+namespace banjo
+{
+
+// An arena is a region-based allocator. Objects are allocated by
+// bumping a pointer through a sequence of large blocks, and all of
+// the objects are released at once when the arena is destroyed.
+//
+// Objects with non-trivial destructors (all terms, since they are
+// polymorphic) are registered with the arena so that they can be
+// destroyed in the reverse order of their construction. Individual
+// objects are never freed.
+//
+// Requests larger than a quarter of a block are given a block of
+// their own so that they do not waste the remainder of the current
+// block.
+//
+// When BANJO_HEAP_ALLOCATION is defined, each object is allocated
+// separately with operator new. This is primarily useful for memory
+// checkers and for comparing against the arena (see the arena
+// benchmark).
+struct Arena
+{
+  static constexpr std::size_t block_size = 64 * 1024;
+
+  Arena();
+  ~Arena();
+
+  // Non-copyable
+  Arena(Arena const&) = delete;
+  Arena& operator=(Arena const&) = delete;
+
+  void* allocate(std::size_t, std::size_t);
+
+  template<typename T, typename... Args>
+  T& make(Args&&...);
+
+  // Statistics
+  std::size_t objects() const   { return count; }
+  std::size_t allocated() const { return used; }
+  std::size_t reserved() const  { return total; }
+  std::size_t blocks() const    { return nblocks; }
+
+private:
+  // A block is a header preceding a contiguous region of memory.
+  struct Block
+  {
+    Block* next;
+  };
+
+  // A pending destructor call.
+  struct Cleanup
+  {
+    void (*fn)(void*);
+    void* obj;
+  };
+
+  template<typename T>
+  static void destroy(void* p) { static_cast<T*>(p)->~T(); }
+
+  void* allocate_block(std::size_t, std::size_t);
+
+  char*  first;   // The next free byte in the current block
+  char*  last;    // The end of the current block
+  Block* head;    // The list of allocated blocks
+
+  std::vector<Cleanup> dtors;
+
+  std::size_t count;   // Objects constructed
+  std::size_t used;    // Bytes handed out
+  std::size_t total;   // Bytes obtained from the system
+  std::size_t nblocks; // Blocks obtained from the system
+};
+
+
+// Allocate and construct an object of type T. If T has a non-trivial
+// destructor, it is invoked when the arena is destroyed.
+template<typename T, typename... Args>
+T&
+Arena::make(Args&&... args)
+{
+  void* p = allocate(sizeof(T), alignof(T));
+  T* t = new (p) T(std::forward<Args>(args)...);
+  if (!std::is_trivially_destructible<T>::value)
+    dtors.push_back({&destroy<T>, t});
+  ++count;
+  return *t;
+}
+
+
+} // namespace banjo
+
+
+#endif
@@ -25,6 +25,8 @@ namespace banjo
 // TODO: I'm not currently using this, but it might be useful.
 struct Translation_unit : Term
 {
+  Term_kind term_kind() const { return Term_kinds<Translation_unit>::first; }
+
   Decl_list first;
 };
 
@@ -8,6 +8,7 @@
 // supporting structures.
 
 #include "prelude.hpp"
+#include "kind.hpp"
 
 #include <lingo/integer.hpp>
 #include <lingo/real.hpp>
@@ -52,6 +53,7 @@ struct Class_type;
 struct Union_type;
 struct Enum_type;
 struct Typename_type;
+struct User_defined_type;
 struct Synthetic_type;
 
 struct Expr;
@@ -85,6 +87,7 @@ struct Requires_expr;
 struct Synthetic_expr;
 
 struct Conv;
+struct Standard_conv;
 struct Value_conv;
 struct Qualification_conv;
 struct Boolean_conv;
@@ -117,6 +120,8 @@ struct Declaration_stmt;
 struct Return_stmt;
 
 struct Decl;
+struct Object_decl;
+struct Type_decl;
 struct Variable_decl;
 struct Constant_decl;
 struct Function_decl;
@@ -152,8 +157,11 @@ struct Conversion_cons;
 struct Deduction_cons;
 struct Conjunction_cons;
 struct Disjunction_cons;
+struct Binary_cons;
 struct Parameterized_cons;
 
+struct Translation_unit;
+
 struct Scope;
 
 using lingo::Integer;
@@ -180,10 +188,246 @@ struct Term
   // and ends at the term's location.
   virtual Region region() const { return {loc, loc}; }
 
+  // Returns the kind of the term. Each concrete class of terms
+  // returns the kind given by Term_kinds. See kind_of.
+  virtual Term_kind term_kind() const = 0;
+
   Location loc;
+
+  // The structural hash value of the term. This is computed on
+  // first use and is 0 until then. See hash.cpp.
+  mutable std::size_t hash = 0;
+
+  // The kind of term. See kind.hpp.
+  mutable Term_kind tag = unknown_kind;
 };
 
 
+// Returns the kind of t. The kind is recorded when t is created by
+// the builder, and otherwise on first use.
+inline Term_kind
+kind_of(Term const& t)
+{
+  if (t.tag == unknown_kind)
+    t.tag = t.term_kind();
+  return t.tag;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Kinds
+
+// The range of kinds [first, last] spanned by a class of terms.
+template<Term_kind F, Term_kind L = F>
+struct Kind_range
+{
+  static constexpr Term_kind first = F;
+  static constexpr Term_kind last = L;
+};
+
+
+// Maps each class of terms to its range of kinds.
+template<typename T>
+struct Term_kinds;
+
+
+template<> struct Term_kinds<Term> : Kind_range<translation_unit_kind, disjunction_cons_kind> { };
+template<> struct Term_kinds<Translation_unit> : Kind_range<translation_unit_kind> { };
+
+// Base classes
+template<> struct Term_kinds<Name> : Kind_range<simple_id_kind, qualified_id_kind> { };
+template<> struct Term_kinds<User_defined_type> : Kind_range<class_type_kind, synthetic_type_kind> { };
+template<> struct Term_kinds<Type> : Kind_range<void_type_kind, synthetic_type_kind> { };
+template<> struct Term_kinds<Reference_expr> : Kind_range<reference_expr_kind, template_ref_kind> { };
+template<> struct Term_kinds<Unary_expr> : Kind_range<neg_expr_kind, not_expr_kind> { };
+template<> struct Term_kinds<Binary_expr> : Kind_range<add_expr_kind, assign_expr_kind> { };
+template<> struct Term_kinds<Standard_conv> : Kind_range<value_conv_kind, numeric_conv_kind> { };
+template<> struct Term_kinds<Conv> : Kind_range<value_conv_kind, ellipsis_conv_kind> { };
+template<> struct Term_kinds<Init> : Kind_range<trivial_init_kind, aggregate_init_kind> { };
+template<> struct Term_kinds<Expr> : Kind_range<boolean_expr_kind, aggregate_init_kind> { };
+template<> struct Term_kinds<Stmt> : Kind_range<compound_stmt_kind, return_stmt_kind> { };
+template<> struct Term_kinds<Object_decl> : Kind_range<variable_decl_kind, value_parm_kind> { };
+template<> struct Term_kinds<Type_decl> : Kind_range<class_decl_kind, enum_decl_kind> { };
+template<> struct Term_kinds<Decl> : Kind_range<variable_decl_kind, template_parm_kind> { };
+template<> struct Term_kinds<Def> : Kind_range<defaulted_def_kind, concept_def_kind> { };
+template<> struct Term_kinds<Req> : Kind_range<type_req_kind, deduction_req_kind> { };
+template<> struct Term_kinds<Binary_cons> : Kind_range<conjunction_cons_kind, disjunction_cons_kind> { };
+template<> struct Term_kinds<Cons> : Kind_range<concept_cons_kind, disjunction_cons_kind> { };
+
+// Concrete classes
+template<> struct Term_kinds<Simple_id> : Kind_range<simple_id_kind> { };
+template<> struct Term_kinds<Global_id> : Kind_range<global_id_kind> { };
+template<> struct Term_kinds<Placeholder_id> : Kind_range<placeholder_id_kind> { };
+template<> struct Term_kinds<Operator_id> : Kind_range<operator_id_kind> { };
+template<> struct Term_kinds<Conversion_id> : Kind_range<conversion_id_kind> { };
+template<> struct Term_kinds<Literal_id> : Kind_range<literal_id_kind> { };
+template<> struct Term_kinds<Destructor_id> : Kind_range<destructor_id_kind> { };
+template<> struct Term_kinds<Template_id> : Kind_range<template_id_kind> { };
+template<> struct Term_kinds<Concept_id> : Kind_range<concept_id_kind> { };
+template<> struct Term_kinds<Qualified_id> : Kind_range<qualified_id_kind> { };
+template<> struct Term_kinds<Void_type> : Kind_range<void_type_kind> { };
+template<> struct Term_kinds<Boolean_type> : Kind_range<boolean_type_kind> { };
+template<> struct Term_kinds<Byte_type> : Kind_range<byte_type_kind> { };
+template<> struct Term_kinds<Integer_type> : Kind_range<integer_type_kind> { };
+template<> struct Term_kinds<Float_type> : Kind_range<float_type_kind> { };
+template<> struct Term_kinds<Auto_type> : Kind_range<auto_type_kind> { };
+template<> struct Term_kinds<Decltype_type> : Kind_range<decltype_type_kind> { };
+template<> struct Term_kinds<Declauto_type> : Kind_range<declauto_type_kind> { };
+template<> struct Term_kinds<Function_type> : Kind_range<function_type_kind> { };
+template<> struct Term_kinds<Qualified_type> : Kind_range<qualified_type_kind> { };
+template<> struct Term_kinds<Pointer_type> : Kind_range<pointer_type_kind> { };
+template<> struct Term_kinds<Reference_type> : Kind_range<reference_type_kind> { };
+template<> struct Term_kinds<Array_type> : Kind_range<array_type_kind> { };
+template<> struct Term_kinds<Sequence_type> : Kind_range<sequence_type_kind> { };
+template<> struct Term_kinds<Class_type> : Kind_range<class_type_kind> { };
+template<> struct Term_kinds<Union_type> : Kind_range<union_type_kind> { };
+template<> struct Term_kinds<Enum_type> : Kind_range<enum_type_kind> { };
+template<> struct Term_kinds<Typename_type> : Kind_range<typename_type_kind> { };
+template<> struct Term_kinds<Synthetic_type> : Kind_range<synthetic_type_kind> { };
+template<> struct Term_kinds<Boolean_expr> : Kind_range<boolean_expr_kind> { };
+template<> struct Term_kinds<Integer_expr> : Kind_range<integer_expr_kind> { };
+template<> struct Term_kinds<Real_expr> : Kind_range<real_expr_kind> { };
+template<> struct Term_kinds<Template_ref> : Kind_range<template_ref_kind> { };
+template<> struct Term_kinds<Check_expr> : Kind_range<check_expr_kind> { };
+template<> struct Term_kinds<Neg_expr> : Kind_range<neg_expr_kind> { };
+template<> struct Term_kinds<Pos_expr> : Kind_range<pos_expr_kind> { };
+template<> struct Term_kinds<Not_expr> : Kind_range<not_expr_kind> { };
+template<> struct Term_kinds<Add_expr> : Kind_range<add_expr_kind> { };
+template<> struct Term_kinds<Sub_expr> : Kind_range<sub_expr_kind> { };
+template<> struct Term_kinds<Mul_expr> : Kind_range<mul_expr_kind> { };
+template<> struct Term_kinds<Div_expr> : Kind_range<div_expr_kind> { };
+template<> struct Term_kinds<Rem_expr> : Kind_range<rem_expr_kind> { };
+template<> struct Term_kinds<Eq_expr> : Kind_range<eq_expr_kind> { };
+template<> struct Term_kinds<Ne_expr> : Kind_range<ne_expr_kind> { };
+template<> struct Term_kinds<Lt_expr> : Kind_range<lt_expr_kind> { };
+template<> struct Term_kinds<Gt_expr> : Kind_range<gt_expr_kind> { };
+template<> struct Term_kinds<Le_expr> : Kind_range<le_expr_kind> { };
+template<> struct Term_kinds<Ge_expr> : Kind_range<ge_expr_kind> { };
+template<> struct Term_kinds<And_expr> : Kind_range<and_expr_kind> { };
+template<> struct Term_kinds<Or_expr> : Kind_range<or_expr_kind> { };
+template<> struct Term_kinds<Assign_expr> : Kind_range<assign_expr_kind> { };
+template<> struct Term_kinds<Call_expr> : Kind_range<call_expr_kind> { };
+template<> struct Term_kinds<Requires_expr> : Kind_range<requires_expr_kind> { };
+template<> struct Term_kinds<Synthetic_expr> : Kind_range<synthetic_expr_kind> { };
+template<> struct Term_kinds<Value_conv> : Kind_range<value_conv_kind> { };
+template<> struct Term_kinds<Qualification_conv> : Kind_range<qualification_conv_kind> { };
+template<> struct Term_kinds<Boolean_conv> : Kind_range<boolean_conv_kind> { };
+template<> struct Term_kinds<Integer_conv> : Kind_range<integer_conv_kind> { };
+template<> struct Term_kinds<Float_conv> : Kind_range<float_conv_kind> { };
+template<> struct Term_kinds<Numeric_conv> : Kind_range<numeric_conv_kind> { };
+template<> struct Term_kinds<Dependent_conv> : Kind_range<dependent_conv_kind> { };
+template<> struct Term_kinds<Ellipsis_conv> : Kind_range<ellipsis_conv_kind> { };
+template<> struct Term_kinds<Trivial_init> : Kind_range<trivial_init_kind> { };
+template<> struct Term_kinds<Copy_init> : Kind_range<copy_init_kind> { };
+template<> struct Term_kinds<Bind_init> : Kind_range<bind_init_kind> { };
+template<> struct Term_kinds<Direct_init> : Kind_range<direct_init_kind> { };
+template<> struct Term_kinds<Aggregate_init> : Kind_range<aggregate_init_kind> { };
+template<> struct Term_kinds<Compound_stmt> : Kind_range<compound_stmt_kind> { };
+template<> struct Term_kinds<Expression_stmt> : Kind_range<expression_stmt_kind> { };
+template<> struct Term_kinds<Declaration_stmt> : Kind_range<declaration_stmt_kind> { };
+template<> struct Term_kinds<Return_stmt> : Kind_range<return_stmt_kind> { };
+template<> struct Term_kinds<Variable_decl> : Kind_range<variable_decl_kind> { };
+template<> struct Term_kinds<Constant_decl> : Kind_range<constant_decl_kind> { };
+template<> struct Term_kinds<Object_parm> : Kind_range<object_parm_kind> { };
+template<> struct Term_kinds<Value_parm> : Kind_range<value_parm_kind> { };
+template<> struct Term_kinds<Function_decl> : Kind_range<function_decl_kind> { };
+template<> struct Term_kinds<Class_decl> : Kind_range<class_decl_kind> { };
+template<> struct Term_kinds<Union_decl> : Kind_range<union_decl_kind> { };
+template<> struct Term_kinds<Enum_decl> : Kind_range<enum_decl_kind> { };
+template<> struct Term_kinds<Namespace_decl> : Kind_range<namespace_decl_kind> { };
+template<> struct Term_kinds<Template_decl> : Kind_range<template_decl_kind> { };
+template<> struct Term_kinds<Concept_decl> : Kind_range<concept_decl_kind> { };
+template<> struct Term_kinds<Axiom_decl> : Kind_range<axiom_decl_kind> { };
+template<> struct Term_kinds<Variadic_parm> : Kind_range<variadic_parm_kind> { };
+template<> struct Term_kinds<Type_parm> : Kind_range<type_parm_kind> { };
+template<> struct Term_kinds<Template_parm> : Kind_range<template_parm_kind> { };
+template<> struct Term_kinds<Defaulted_def> : Kind_range<defaulted_def_kind> { };
+template<> struct Term_kinds<Deleted_def> : Kind_range<deleted_def_kind> { };
+template<> struct Term_kinds<Expression_def> : Kind_range<expression_def_kind> { };
+template<> struct Term_kinds<Function_def> : Kind_range<function_def_kind> { };
+template<> struct Term_kinds<Class_def> : Kind_range<class_def_kind> { };
+template<> struct Term_kinds<Union_def> : Kind_range<union_def_kind> { };
+template<> struct Term_kinds<Enum_def> : Kind_range<enum_def_kind> { };
+template<> struct Term_kinds<Concept_def> : Kind_range<concept_def_kind> { };
+template<> struct Term_kinds<Type_req> : Kind_range<type_req_kind> { };
+template<> struct Term_kinds<Syntactic_req> : Kind_range<syntactic_req_kind> { };
+template<> struct Term_kinds<Semantic_req> : Kind_range<semantic_req_kind> { };
+template<> struct Term_kinds<Expression_req> : Kind_range<expression_req_kind> { };
+template<> struct Term_kinds<Basic_req> : Kind_range<basic_req_kind> { };
+template<> struct Term_kinds<Conversion_req> : Kind_range<conversion_req_kind> { };
+template<> struct Term_kinds<Deduction_req> : Kind_range<deduction_req_kind> { };
+template<> struct Term_kinds<Concept_cons> : Kind_range<concept_cons_kind> { };
+template<> struct Term_kinds<Predicate_cons> : Kind_range<predicate_cons_kind> { };
+template<> struct Term_kinds<Expression_cons> : Kind_range<expression_cons_kind> { };
+template<> struct Term_kinds<Type_cons> : Kind_range<type_cons_kind> { };
+template<> struct Term_kinds<Conversion_cons> : Kind_range<conversion_cons_kind> { };
+template<> struct Term_kinds<Deduction_cons> : Kind_range<deduction_cons_kind> { };
+template<> struct Term_kinds<Parameterized_cons> : Kind_range<parameterized_cons_kind> { };
+template<> struct Term_kinds<Conjunction_cons> : Kind_range<conjunction_cons_kind> { };
+template<> struct Term_kinds<Disjunction_cons> : Kind_range<disjunction_cons_kind> { };
+
+
+// Returns true if t is an instance of T.
+template<typename T, typename U>
+inline bool
+isa(U const& t)
+{
+  using K = Term_kinds<T>;
+  Term_kind k = kind_of(t);
+  return K::first <= k && k <= K::last;
+}
+
+
+// Returns true if p is non-null and points to an instance of T.
+template<typename T, typename U>
+inline bool
+isa(U* p)
+{
+  return p && isa<T>(*p);
+}
+
+
+// Returns p converted to a pointer to T, or nullptr if p does not
+// point to an instance of T.
+template<typename T, typename U>
+inline T*
+dyn_cast(U* p)
+{
+  return isa<T>(p) ? static_cast<T*>(p) : nullptr;
+}
+
+
+template<typename T, typename U>
+inline T const*
+dyn_cast(U const* p)
+{
+  return isa<T>(p) ? static_cast<T const*>(p) : nullptr;
+}
+
+
+// Record the kind of a newly created term of concrete type T. The
+// kind of a concrete class is the first in its range.
+template<typename T>
+inline T&
+set_kind(T& t)
+{
+  static_cast<Term const&>(t).tag = Term_kinds<T>::first;
+  return t;
+}
+
+
+// Calls fn with t converted to its dynamic type U, converting the
+// result to T. This is used by the apply() functions, which dispatch
+// on the kind of a term rather than through its visitor. Converting
+// to T allows a void result to be returned from a void function.
+template<typename U, typename T, typename F, typename V>
+inline T
+invoke_as(F& fn, V& t)
+{
+  return static_cast<T>(fn(static_cast<U&>(t)));
+}
+
+
 // -------------------------------------------------------------------------- //
 // Lists
 
@@ -272,6 +516,9 @@ struct List : Term, std::vector<T*>
     : base_type(list)
   { }
 
+  // Lists are not classified.
+  Term_kind term_kind() const { return unknown_kind; }
+
   std::vector<T*> const& base() const { return *this; }
   std::vector<T*>&       base()       { return *this; }
 
@@ -340,6 +587,31 @@ struct Index : std::pair<int, int>
 };
 
 
+// Flags describing how a type or expression depends on template
+// parameters. The flags of a term are computed from those of its
+// components when the term is built (see set_dependence), so
+// dependence queries never traverse a term.
+enum Dependence : unsigned char
+{
+  type_dependent_flag     = 0x01, // Is, or has, a dependent type
+  value_dependent_flag    = 0x02, // Has a value depending on parameters
+  contains_parameter_flag = 0x04  // Must be rebuilt by substitution
+};
+
+
+// The flags of a dependent type, or of an expression having one.
+constexpr int dependent_flags =
+  type_dependent_flag | value_dependent_flag | contains_parameter_flag;
+
+
+// Terms other than types and expressions carry no dependence.
+inline Term&
+set_dependence(Term& t)
+{
+  return t;
+}
+
+
 } // namesapce banjo
 
 #endif
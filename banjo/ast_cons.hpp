@@ -18,8 +18,19 @@ struct Cons : Term
   struct Visitor;
   struct Mutator;
 
+  Cons()
+    : id(-1)
+  { }
+
   virtual void accept(Visitor&) const = 0;
   virtual void accept(Mutator&) = 0;
+
+  // Returns the unique id of the constraint. Unique constraints
+  // (those created by the builder) are numbered densely from 0 in
+  // order of creation. Other constraints have id -1.
+  int unique_id() const { return id; }
+
+  int id;
 };
 
 
@@ -62,6 +73,7 @@ struct Concept_cons : Cons
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Concept_cons>::first; }
 
   // Returns the resolved concept declaration.
   Concept_decl const& declaration() const { return cast<Concept_decl>(*decl); }
@@ -85,6 +97,7 @@ struct Predicate_cons : Cons
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Predicate_cons>::first; }
 
   // Returns the expression to be evaluated.
   Expr const& expression() const { return *expr; }
@@ -103,6 +116,7 @@ struct Expression_cons : Cons
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Expression_cons>::first; }
 
   Expr const& expression() const { return *expr; }
   Expr&       expression()       { return *expr; }
@@ -122,6 +136,7 @@ struct Type_cons : Cons
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Type_cons>::first; }
 };
 
 
@@ -134,6 +149,7 @@ struct Conversion_cons : Cons
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Conversion_cons>::first; }
 
   Expr const& expression() const { return *expr; }
   Expr&       expression()       { return *expr; }
@@ -153,6 +169,7 @@ struct Deduction_cons : Cons
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Deduction_cons>::first; }
 };
 
 
@@ -167,6 +184,7 @@ struct Parameterized_cons : Cons
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Parameterized_cons>::first; }
 
   Decl_list const& variables() const { return vars; }
   Decl_list&       variables()       { return vars; }
@@ -206,6 +224,7 @@ struct Conjunction_cons : Binary_cons
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Conjunction_cons>::first; }
 };
 
 
@@ -216,6 +235,7 @@ struct Disjunction_cons : Binary_cons
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Disjunction_cons>::first; }
 };
 
 
@@ -239,11 +259,27 @@ struct Generic_cons_visitor : Cons::Visitor, Generic_visitor<F, T>
 };
 
 
-// Apply a function to the given constraint.
+// Apply a function to the given constraint. This dispatches on the kind
+// of c instead of calling through the visitor. Kinds without a case
+// fall back to the visitor.
 template<typename F, typename T = typename std::result_of<F(Concept_cons const&)>::type>
-inline decltype(auto)
+inline T
 apply(Cons const& c, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(c)) {
+    case concept_cons_kind:       return invoke_as<Concept_cons const, T>(fn, c);
+    case expression_cons_kind:    return invoke_as<Expression_cons const, T>(fn, c);
+    case type_cons_kind:          return invoke_as<Type_cons const, T>(fn, c);
+    case predicate_cons_kind:     return invoke_as<Predicate_cons const, T>(fn, c);
+    case conversion_cons_kind:    return invoke_as<Conversion_cons const, T>(fn, c);
+    case deduction_cons_kind:     return invoke_as<Deduction_cons const, T>(fn, c);
+    case conjunction_cons_kind:   return invoke_as<Conjunction_cons const, T>(fn, c);
+    case disjunction_cons_kind:   return invoke_as<Disjunction_cons const, T>(fn, c);
+    case parameterized_cons_kind: return invoke_as<Parameterized_cons const, T>(fn, c);
+    default: break;
+  }
+#endif
   Generic_cons_visitor<F, T> vis(fn);
   return accept(c, vis);
 }
@@ -269,11 +305,27 @@ struct Generic_cons_mutator : Cons::Mutator, Generic_mutator<F, T>
 };
 
 
-// Apply a function to the given name.
+// Apply a function to the given constraint. This dispatches on the kind
+// of c instead of calling through the mutator. Kinds without a case
+// fall back to the mutator.
 template<typename F, typename T = typename std::result_of<F(Concept_cons&)>::type>
-inline decltype(auto)
+inline T
 apply(Cons& c, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(c)) {
+    case concept_cons_kind:       return invoke_as<Concept_cons, T>(fn, c);
+    case expression_cons_kind:    return invoke_as<Expression_cons, T>(fn, c);
+    case type_cons_kind:          return invoke_as<Type_cons, T>(fn, c);
+    case predicate_cons_kind:     return invoke_as<Predicate_cons, T>(fn, c);
+    case conversion_cons_kind:    return invoke_as<Conversion_cons, T>(fn, c);
+    case deduction_cons_kind:     return invoke_as<Deduction_cons, T>(fn, c);
+    case conjunction_cons_kind:   return invoke_as<Conjunction_cons, T>(fn, c);
+    case disjunction_cons_kind:   return invoke_as<Disjunction_cons, T>(fn, c);
+    case parameterized_cons_kind: return invoke_as<Parameterized_cons, T>(fn, c);
+    default: break;
+  }
+#endif
   Generic_cons_mutator<F, T> vis(fn);
   return accept(c, vis);
 }
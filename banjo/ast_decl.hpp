@@ -6,6 +6,7 @@
 
 #include "ast_base.hpp"
 #include "specifier.hpp"
+#include "memo.hpp"
 
 
 namespace banjo
@@ -111,11 +112,11 @@ struct Decl::Mutator
 struct Object_decl : Decl
 {
   Object_decl(Name& n, Type& t)
-    : Decl(n), ty(&t), init()
+    : Decl(n), ty(&t), init(), slot(-1)
   { }
 
   Object_decl(Name& n, Type& t, Expr& e)
-    : Decl(n), ty(&t), init(&e)
+    : Decl(n), ty(&t), init(&e), slot(-1)
   { }
 
   Type const& type() const { return *ty; }
@@ -123,6 +124,10 @@ struct Object_decl : Decl
 
   Type* ty;
   Expr* init;
+
+  // The index of the object in the frame of its enclosing function,
+  // or -1 if the object is not local to a function.
+  int slot;
 };
 
 
@@ -159,6 +164,7 @@ struct Variable_decl : Object_decl
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Variable_decl>::first; }
 
   // Returns the initializer for the variable. This is
   // defined iff has_initializer() is true.
@@ -181,6 +187,7 @@ struct Constant_decl : Object_decl
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Constant_decl>::first; }
 
   // Returns the initializer for the variable. This is
   // defined iff has_initializer() is true.
@@ -199,15 +206,16 @@ struct Constant_decl : Object_decl
 struct Function_decl : Decl
 {
   Function_decl(Name& n, Type& t, Decl_list const& p)
-    : Decl(n), ty(&t), parms(p), def()
+    : Decl(n), ty(&t), parms(p), def(), frame(-1)
   { }
 
   Function_decl(Name& n, Type& t, Decl_list const& p, Def& d)
-    : Decl(n), ty(&t), parms(p), def(&d)
+    : Decl(n), ty(&t), parms(p), def(&d), frame(-1)
   { }
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Function_decl>::first; }
 
   // Returns the type of this declaration.
   Function_type const& type() const;
@@ -245,6 +253,10 @@ struct Function_decl : Decl
   Expr*     pre;
   Expr*     post;
   Def*      def;
+
+  // The number of slots for parameters and local variables, or -1
+  // if slots have not been assigned. See allocate_frame().
+  int frame;
 };
 
 
@@ -255,6 +267,7 @@ struct Class_decl : Type_decl
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Class_decl>::first; }
 
   // Returns the definition for the class, if given. Behavior is
   // defined iff is_definition() is true.
@@ -272,6 +285,7 @@ struct Union_decl : Type_decl
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Union_decl>::first; }
 
   Union_def const& definition() const;
   Union_def&       definition();
@@ -284,6 +298,7 @@ struct Enum_decl : Type_decl
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Enum_decl>::first; }
 
   Enum_def const& definition() const;
   Enum_def&       definition();
@@ -319,6 +334,7 @@ struct Namespace_decl : Decl
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Namespace_decl>::first; }
 
   bool is_global() const    { return cxt == nullptr; }
   bool is_anonymous() const;
@@ -338,6 +354,27 @@ struct Namespace_decl : Decl
 };
 
 
+// Hashing and comparison for lists of template arguments. Arguments
+// are compared by equivalence, not identity. These are defined in
+// template.cpp.
+struct Template_args_hash
+{
+  std::size_t operator()(Term_list const&) const;
+};
+
+
+struct Template_args_eq
+{
+  bool operator()(Term_list const&, Term_list const&) const;
+};
+
+
+// A table of the specializations of a template, keyed on the
+// (converted) template arguments of each specialization.
+using Specialization_table =
+  Memo_table<Term_list, Decl*, Template_args_hash, Template_args_eq>;
+
+
 // Declares a template.
 //
 // A template has a single constraint expression corresponding
@@ -351,7 +388,7 @@ struct Namespace_decl : Decl
 struct Template_decl : Decl
 {
   Template_decl(Decl_list const& p, Decl& d)
-    : Decl(d.name()), parms(p), cons(nullptr), decl(&d)
+    : Decl(d.name()), parms(p), cons(nullptr), norm(nullptr), decl(&d)
   {
     lingo_assert(!d.context());
     d.context(*this);
@@ -359,6 +396,7 @@ struct Template_decl : Decl
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Template_decl>::first; }
 
   // Returns the template parameters of the declaration.
   Decl_list const& parameters() const { return parms; }
@@ -369,21 +407,37 @@ struct Template_decl : Decl
   Expr const& constraint() const  { return *cons; }
   Expr&       constraint()        { return *cons; }
 
-  // Set the template constraints.
+  // Set the template constraints, discarding any previous normal form.
   //
   // TODO: Is this used anywhere?
-  void        constrain(Expr& e)  { cons = &e; }
+  void        constrain(Expr& e)  { cons = &e; norm = nullptr; }
 
   // Returns true if the template declaration has constraints.
   bool is_constrained() const { return cons; }
 
+  // Returns the normal form of the template's constraint. This is
+  // valid iff is_normalized() is true. See normalize() in
+  // normalization.hpp.
+  Cons const& normalized_constraint() const { return *norm; }
+  Cons&       normalized_constraint()       { return *norm; }
+
+  // Returns true if the normalized constraint has been computed.
+  bool is_normalized() const { return norm; }
+
   // Returns the underlying pattern.
   Decl const& parameterized_declaration() const { return *decl; }
   Decl&       parameterized_declaration()       { return *decl; }
 
-  Decl_list parms;
-  Expr*     cons;
-  Decl*     decl;
+  // Returns the table of specializations of the template. See
+  // specialize_template() in template.hpp.
+  Specialization_table const& specializations() const { return specs; }
+  Specialization_table&       specializations()       { return specs; }
+
+  Decl_list            parms;
+  Expr*                cons;
+  Cons*                norm;
+  Decl*                decl;
+  Specialization_table specs;
 };
 
 
@@ -400,6 +454,7 @@ struct Concept_decl : Decl
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Concept_decl>::first; }
 
   // Returns the template parameters of the declaration.
   Decl_list const& parameters() const { return parms; }
@@ -431,6 +486,7 @@ struct Axiom_decl : Decl
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Axiom_decl>::first; }
 
   // Returns the list of parameters in terms of which the requirements
   // are written.
@@ -491,6 +547,7 @@ struct Object_parm : Parameter_decl<Object_decl>
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Object_parm>::first; }
 
   // Returns the default argument for the parameter.
   // This is valid iff has_default_arguement() is true.
@@ -517,6 +574,7 @@ struct Value_parm : Parameter_decl<Object_decl>
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Value_parm>::first; }
 
   // Returns the default argument for the parameter.
   // This is valid iff has_default_arguement() is true.
@@ -542,6 +600,7 @@ struct Variadic_parm : Decl
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Variadic_parm>::first; }
 };
 
 
@@ -560,6 +619,7 @@ struct Type_parm : Parameter_decl<Decl>
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Type_parm>::first; }
 
   // Returns the default argument for the parameter.
   // This is valid iff has_default_arguement() is true.
@@ -589,6 +649,7 @@ struct Template_parm : Parameter_decl<Decl>
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Template_parm>::first; }
 
   // Returns the tempalte declaration that defines the
   // signature of accepted arguments.
@@ -667,11 +728,33 @@ struct Generic_decl_visitor : Decl::Visitor, Generic_visitor<F, T>
 };
 
 
-// Apply a function to the given declaration.
+// Apply a function to the given declaration. This dispatches on the kind
+// of d instead of calling through the visitor. Kinds without a case
+// fall back to the visitor.
 template<typename F, typename T = typename std::result_of<F(Variable_decl const&)>::type>
-inline decltype(auto)
+inline T
 apply(Decl const& d, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(d)) {
+    case variable_decl_kind:  return invoke_as<Variable_decl const, T>(fn, d);
+    case constant_decl_kind:  return invoke_as<Constant_decl const, T>(fn, d);
+    case function_decl_kind:  return invoke_as<Function_decl const, T>(fn, d);
+    case class_decl_kind:     return invoke_as<Class_decl const, T>(fn, d);
+    case union_decl_kind:     return invoke_as<Union_decl const, T>(fn, d);
+    case enum_decl_kind:      return invoke_as<Enum_decl const, T>(fn, d);
+    case namespace_decl_kind: return invoke_as<Namespace_decl const, T>(fn, d);
+    case template_decl_kind:  return invoke_as<Template_decl const, T>(fn, d);
+    case concept_decl_kind:   return invoke_as<Concept_decl const, T>(fn, d);
+    case axiom_decl_kind:     return invoke_as<Axiom_decl const, T>(fn, d);
+    case object_parm_kind:    return invoke_as<Object_parm const, T>(fn, d);
+    case value_parm_kind:     return invoke_as<Value_parm const, T>(fn, d);
+    case type_parm_kind:      return invoke_as<Type_parm const, T>(fn, d);
+    case template_parm_kind:  return invoke_as<Template_parm const, T>(fn, d);
+    case variadic_parm_kind:  return invoke_as<Variadic_parm const, T>(fn, d);
+    default: break;
+  }
+#endif
   Generic_decl_visitor<F, T> vis(fn);
   return accept(d, vis);
 }
@@ -703,11 +786,33 @@ struct Generic_decl_mutator : Decl::Mutator, Generic_mutator<F, T>
 };
 
 
-// Apply a function to the given declaration.
+// Apply a function to the given declaration. This dispatches on the kind
+// of d instead of calling through the mutator. Kinds without a case
+// fall back to the mutator.
 template<typename F, typename T = typename std::result_of<F(Variable_decl&)>::type>
-inline decltype(auto)
+inline T
 apply(Decl& d, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(d)) {
+    case variable_decl_kind:  return invoke_as<Variable_decl, T>(fn, d);
+    case constant_decl_kind:  return invoke_as<Constant_decl, T>(fn, d);
+    case function_decl_kind:  return invoke_as<Function_decl, T>(fn, d);
+    case class_decl_kind:     return invoke_as<Class_decl, T>(fn, d);
+    case union_decl_kind:     return invoke_as<Union_decl, T>(fn, d);
+    case enum_decl_kind:      return invoke_as<Enum_decl, T>(fn, d);
+    case namespace_decl_kind: return invoke_as<Namespace_decl, T>(fn, d);
+    case template_decl_kind:  return invoke_as<Template_decl, T>(fn, d);
+    case concept_decl_kind:   return invoke_as<Concept_decl, T>(fn, d);
+    case axiom_decl_kind:     return invoke_as<Axiom_decl, T>(fn, d);
+    case object_parm_kind:    return invoke_as<Object_parm, T>(fn, d);
+    case value_parm_kind:     return invoke_as<Value_parm, T>(fn, d);
+    case type_parm_kind:      return invoke_as<Type_parm, T>(fn, d);
+    case template_parm_kind:  return invoke_as<Template_parm, T>(fn, d);
+    case variadic_parm_kind:  return invoke_as<Variadic_parm, T>(fn, d);
+    default: break;
+  }
+#endif
   Generic_decl_mutator<F, T> vis(fn);
   return accept(d, vis);
 }
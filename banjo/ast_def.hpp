@@ -66,6 +66,7 @@ struct Defaulted_def : Def
 {
   void accept(Visitor& v) const { return v.visit(*this); }
   void accept(Mutator& v)       { return v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Defaulted_def>::first; }
 };
 
 
@@ -77,6 +78,7 @@ struct Deleted_def : Def
 {
   void accept(Visitor& v) const { return v.visit(*this); }
   void accept(Mutator& v)       { return v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Deleted_def>::first; }
 };
 
 
@@ -90,6 +92,7 @@ struct Expression_def : Def
 
   void accept(Visitor& v) const { return v.visit(*this); }
   void accept(Mutator& v)       { return v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Expression_def>::first; }
 
   // Returns the expression that defines the entity.
   Expr const& expression() const { return *expr; }
@@ -112,6 +115,7 @@ struct Function_def : Def
 
   void accept(Visitor& v) const { return v.visit(*this); }
   void accept(Mutator& v)       { return v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Function_def>::first; }
 
   // Returns the statement associated with the function
   // definition.
@@ -133,6 +137,7 @@ struct Class_def : Def
 
   void accept(Visitor& v) const { return v.visit(*this); }
   void accept(Mutator& v)       { return v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Class_def>::first; }
 
   // Returns the list of member declarations.
   Decl_list const& members() const { return decls; }
@@ -147,6 +152,7 @@ struct Union_def : Def
 {
   void accept(Visitor& v) const { return v.visit(*this); }
   void accept(Mutator& v)       { return v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Union_def>::first; }
 };
 
 
@@ -155,6 +161,7 @@ struct Enum_def : Def
 {
   void accept(Visitor& v) const { return v.visit(*this); }
   void accept(Mutator& v)       { return v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Enum_def>::first; }
 };
 
 
@@ -167,6 +174,7 @@ struct Concept_def : Def
 
   void accept(Visitor& v) const { return v.visit(*this); }
   void accept(Mutator& v)       { return v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Concept_def>::first; }
 
   // Returns the sequence of required declarations.
   Req_list const& requirements() const { return reqs; }
@@ -195,10 +203,26 @@ struct Generic_def_visitor : Def::Visitor, Generic_visitor<F, T>
 };
 
 
+// Apply a function to the given definition. This dispatches on the kind
+// of t instead of calling through the visitor. Kinds without a case
+// fall back to the visitor.
 template<typename F, typename T = typename std::result_of<F(Defaulted_def const&)>::type>
-inline decltype(auto)
+inline T
 apply(Def const& t, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(t)) {
+    case defaulted_def_kind:  return invoke_as<Defaulted_def const, T>(fn, t);
+    case deleted_def_kind:    return invoke_as<Deleted_def const, T>(fn, t);
+    case expression_def_kind: return invoke_as<Expression_def const, T>(fn, t);
+    case function_def_kind:   return invoke_as<Function_def const, T>(fn, t);
+    case class_def_kind:      return invoke_as<Class_def const, T>(fn, t);
+    case union_def_kind:      return invoke_as<Union_def const, T>(fn, t);
+    case enum_def_kind:       return invoke_as<Enum_def const, T>(fn, t);
+    case concept_def_kind:    return invoke_as<Concept_def const, T>(fn, t);
+    default: break;
+  }
+#endif
   Generic_def_visitor<F, T> vis(fn);
   return accept(t, vis);
 }
@@ -206,10 +230,10 @@ apply(Def const& t, F fn)
 
 // A generic mutator for definitions.
 template<typename F, typename T>
-struct Generic_def_mutator : Def::Mutator, Generic_visitor<F, T>
+struct Generic_def_mutator : Def::Mutator, Generic_mutator<F, T>
 {
   Generic_def_mutator(F f)
-    : Generic_visitor<F, T>(f)
+    : Generic_mutator<F, T>(f)
   { }
 
   void visit(Defaulted_def& d)  { this->invoke(d); }
@@ -223,10 +247,26 @@ struct Generic_def_mutator : Def::Mutator, Generic_visitor<F, T>
 };
 
 
+// Apply a function to the given definition. This dispatches on the kind
+// of t instead of calling through the mutator. Kinds without a case
+// fall back to the mutator.
 template<typename F, typename T = typename std::result_of<F(Defaulted_def&)>::type>
-inline decltype(auto)
+inline T
 apply(Def& t, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(t)) {
+    case defaulted_def_kind:  return invoke_as<Defaulted_def, T>(fn, t);
+    case deleted_def_kind:    return invoke_as<Deleted_def, T>(fn, t);
+    case expression_def_kind: return invoke_as<Expression_def, T>(fn, t);
+    case function_def_kind:   return invoke_as<Function_def, T>(fn, t);
+    case class_def_kind:      return invoke_as<Class_def, T>(fn, t);
+    case union_def_kind:      return invoke_as<Union_def, T>(fn, t);
+    case enum_def_kind:       return invoke_as<Enum_def, T>(fn, t);
+    case concept_def_kind:    return invoke_as<Concept_def, T>(fn, t);
+    default: break;
+  }
+#endif
   Generic_def_mutator<F, T> vis(fn);
   return accept(t, vis);
 }
@@ -101,14 +101,114 @@ has_union_type(Expr const& e)
 // Depdendent expressions
 
 
-// Returns true if the expression is type-dependent. An expression
-// is type-dependent if it has dependent type.
+namespace
+{
+
+// Returns the dependence flags of a template argument.
+inline int
+argument_dependence(Term const& t)
+{
+  if (Type const* u = as<Type>(&t))
+    return u->dep;
+  if (Expr const* e = as<Expr>(&t))
+    return e->dep;
+  return 0;
+}
+
+
+// Returns the dependence contributed to an expression by operands
+// having the flags `d`. A dependent operand makes the value of the
+// expression dependent, but not its type; that is determined by
+// the type computed for the expression.
+inline int
+operand_dependence(int d)
+{
+  int r = d & contains_parameter_flag;
+  if (d & (type_dependent_flag | value_dependent_flag))
+    r |= value_dependent_flag;
+  return r;
+}
+
+
+inline int
+operand_dependence(Expr_list const& es)
+{
+  int d = 0;
+  for (Expr const& e : es)
+    d |= e.dep;
+  return operand_dependence(d);
+}
+
+
+} // namespace
+
+
+// Compute the dependence of `e` from that of its type and operands,
+// which is already known. Returns `e`.
+//
+// A reference to an object (i.e., anything but a function or
+// template) is treated as containing a parameter, since substitution
+// rebinds it to the corresponding declaration of an instantiation.
 //
 // TODO: There are probably some other interesting cases here.
+Expr&
+set_dependence(Expr& e)
+{
+  struct fn
+  {
+    int operator()(Expr const& e)           { return 0; }
+    int operator()(Template_ref const& e)   { return 0; }
+    int operator()(Unary_expr const& e)     { return operand_dependence(e.operand().dep); }
+    int operator()(Binary_expr const& e)    { return operand_dependence(e.left().dep | e.right().dep); }
+    int operator()(Conv const& e)           { return operand_dependence(e.source().dep); }
+    int operator()(Copy_init const& e)      { return operand_dependence(e.expression().dep); }
+    int operator()(Bind_init const& e)      { return operand_dependence(e.expression().dep); }
+    int operator()(Direct_init const& e)    { return operand_dependence(e.arguments()); }
+    int operator()(Aggregate_init const& e) { return operand_dependence(e.initializers()); }
+
+    int operator()(Reference_expr const& e)
+    {
+      Decl const& d = e.declaration();
+      if (is<Value_parm>(&d))
+        return value_dependent_flag | contains_parameter_flag;
+      if (is<Function_decl>(&d))
+        return 0;
+      return contains_parameter_flag;
+    }
+
+    int operator()(Check_expr const& e)
+    {
+      int d = 0;
+      for (Term const& t : e.arguments())
+        d |= argument_dependence(t);
+      return operand_dependence(d);
+    }
+
+    int operator()(Call_expr const& e)
+    {
+      return operand_dependence(e.function().dep) | operand_dependence(e.arguments());
+    }
+
+    // Requirements introduce their own parameters.
+    int operator()(Requires_expr const& e)
+    {
+      return value_dependent_flag | contains_parameter_flag;
+    }
+  };
+  int d = apply(e, fn{});
+  if (e.ty && e.ty->is_dependent())
+    d |= dependent_flags;
+  e.dep = d;
+  return e;
+}
+
+
+// Returns true if the expression is type-dependent. An expression
+// is type-dependent if it has dependent type.
 bool
 is_type_dependent(Expr const& e)
 {
-  return is_dependent_type(e.type());
+  return e.is_type_dependent();
 }
 
 
@@ -121,6 +221,15 @@ is_type_dependent(Expr_list const& es)
 }
 
 
+// Returns true if the value of the expression depends on a template
+// parameter. Type-dependent expressions are value-dependent.
+bool
+is_value_dependent(Expr const& e)
+{
+  return e.is_value_dependent();
+}
+
+
 // -------------------------------------------------------------------------- //
 // Declared type of an expression
 
@@ -17,11 +17,11 @@ struct Expr : Term
   struct Mutator;
 
   Expr()
-    : ty(nullptr)
+    : ty(nullptr), dep(0)
   { }
 
   Expr(Type& t)
-    : ty(&t)
+    : ty(&t), dep(0)
   { }
 
   virtual void accept(Visitor&) const = 0;
@@ -30,7 +30,13 @@ struct Expr : Term
   Type const& type() const { return *ty; }
   Type&       type()       { return *ty; }
 
-  Type* ty;
+  // Dependence on template parameters. See set_dependence.
+  bool is_type_dependent() const   { return dep & type_dependent_flag; }
+  bool is_value_dependent() const  { return dep & value_dependent_flag; }
+  bool contains_parameters() const { return dep & contains_parameter_flag; }
+
+  Type*         ty;
+  unsigned char dep;
 };
 
 
@@ -181,6 +187,7 @@ struct Boolean_expr : Literal_expr<bool>
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Boolean_expr>::first; }
 };
 
 
@@ -191,6 +198,7 @@ struct Integer_expr : Literal_expr<Integer>
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Integer_expr>::first; }
 };
 
 
@@ -201,6 +209,7 @@ struct Real_expr : Literal_expr<lingo::Real>
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Real_expr>::first; }
 };
 
 
@@ -218,6 +227,7 @@ struct Reference_expr : Expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return reference_expr_kind; }
 
   // Returns the referenced declaration.
   Decl const& declaration() const { return *decl; }
@@ -241,6 +251,7 @@ struct Template_ref : Reference_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Template_ref>::first; }
 
   // Returns the referenced templaet declaration.
   Template_decl const& declaration() const;
@@ -259,6 +270,7 @@ struct Check_expr : Expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Check_expr>::first; }
 
   Concept_decl const& declaration() const;
   Concept_decl&       declaration();
@@ -278,6 +290,7 @@ struct Add_expr : Binary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Add_expr>::first; }
 };
 
 
@@ -288,6 +301,7 @@ struct Sub_expr : Binary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Sub_expr>::first; }
 };
 
 
@@ -298,6 +312,7 @@ struct Mul_expr : Binary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Mul_expr>::first; }
 };
 
 
@@ -308,6 +323,7 @@ struct Div_expr : Binary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Div_expr>::first; }
 };
 
 
@@ -318,6 +334,7 @@ struct Rem_expr : Binary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Rem_expr>::first; }
 };
 
 
@@ -328,6 +345,7 @@ struct Neg_expr : Unary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Neg_expr>::first; }
 };
 
 
@@ -338,6 +356,7 @@ struct Pos_expr : Unary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Pos_expr>::first; }
 };
 
 
@@ -348,6 +367,7 @@ struct Eq_expr : Binary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Eq_expr>::first; }
 };
 
 
@@ -358,6 +378,7 @@ struct Ne_expr : Binary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Ne_expr>::first; }
 };
 
 
@@ -368,6 +389,7 @@ struct Lt_expr : Binary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Lt_expr>::first; }
 };
 
 
@@ -378,6 +400,7 @@ struct Gt_expr : Binary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Gt_expr>::first; }
 };
 
 
@@ -388,6 +411,7 @@ struct Le_expr : Binary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Le_expr>::first; }
 };
 
 
@@ -398,6 +422,7 @@ struct Ge_expr : Binary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Ge_expr>::first; }
 };
 
 
@@ -408,6 +433,7 @@ struct And_expr : Binary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<And_expr>::first; }
 };
 
 
@@ -418,6 +444,7 @@ struct Or_expr : Binary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Or_expr>::first; }
 };
 
 
@@ -428,6 +455,7 @@ struct Not_expr : Unary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Not_expr>::first; }
 };
 
 
@@ -452,6 +480,7 @@ struct Call_expr : Expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Call_expr>::first; }
 
   Expr const& function() const { return *fn; }
   Expr&       function()       { return *fn; }
@@ -471,6 +500,7 @@ struct Assign_expr : Binary_expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Assign_expr>::first; }
 };
 
 
@@ -485,6 +515,7 @@ struct Requires_expr : Expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Requires_expr>::first; }
 
   // Returns the list of parameters in terms of which the requirements
   // are written.
@@ -519,6 +550,7 @@ struct Synthetic_expr : Expr
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Synthetic_expr>::first; }
 
   // Returns the declaration from which this expression was
   // synthesized.
@@ -577,6 +609,7 @@ struct Value_conv : Standard_conv
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Value_conv>::first; }
 };
 
 
@@ -588,6 +621,7 @@ struct Qualification_conv : Standard_conv
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Qualification_conv>::first; }
 };
 
 
@@ -598,6 +632,7 @@ struct Boolean_conv : Standard_conv
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Boolean_conv>::first; }
 };
 
 
@@ -608,6 +643,7 @@ struct Integer_conv : Standard_conv
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Integer_conv>::first; }
 };
 
 
@@ -618,6 +654,7 @@ struct Float_conv : Standard_conv
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Float_conv>::first; }
 };
 
 
@@ -630,6 +667,7 @@ struct Numeric_conv : Standard_conv
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Numeric_conv>::first; }
 };
 
 
@@ -642,6 +680,7 @@ struct Dependent_conv : Conv
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Dependent_conv>::first; }
 };
 
 
@@ -653,6 +692,7 @@ struct Ellipsis_conv : Conv
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Ellipsis_conv>::first; }
 };
 
 
@@ -682,6 +722,7 @@ struct Trivial_init : Init
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Trivial_init>::first; }
 };
 
 
@@ -696,6 +737,7 @@ struct Copy_init : Init
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Copy_init>::first; }
 
   // Returns the source expression.
   Expr const& expression() const { return *expr; }
@@ -715,6 +757,7 @@ struct Bind_init : Init
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Bind_init>::first; }
 
   // Returns the source expression.
   Expr const& expression() const { return *expr; }
@@ -737,6 +780,7 @@ struct Direct_init : Init
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Direct_init>::first; }
 
   // Returns the constructor declaration
   Decl const& consructor() const { return *ctor; }
@@ -761,6 +805,7 @@ struct Aggregate_init : Init
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Aggregate_init>::first; }
 
   // Returns a sequence of selected initializers for
   // a compound target type.
@@ -784,6 +829,9 @@ bool has_union_type(Expr const&);
 
 bool is_type_dependent(Expr const&);
 bool is_type_dependent(Expr_list const&);
+bool is_value_dependent(Expr const&);
+
+Expr& set_dependence(Expr&);
 
 Type const& declared_type(Expr const&);
 Type&       declared_type(Expr&);
@@ -861,11 +909,57 @@ struct Generic_expr_visitor : Expr::Visitor, Generic_visitor<F, T>
 };
 
 
-// Apply a function to the given type.
+// Apply a function to the given expression. This dispatches on the kind
+// of e instead of calling through the visitor. Kinds without a case
+// fall back to the visitor.
 template<typename F, typename T = typename std::result_of<F(Boolean_expr const&)>::type>
-inline decltype(auto)
+inline T
 apply(Expr const& e, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(e)) {
+    case boolean_expr_kind:       return invoke_as<Boolean_expr const, T>(fn, e);
+    case integer_expr_kind:       return invoke_as<Integer_expr const, T>(fn, e);
+    case real_expr_kind:          return invoke_as<Real_expr const, T>(fn, e);
+    case reference_expr_kind:     return invoke_as<Reference_expr const, T>(fn, e);
+    case template_ref_kind:       return invoke_as<Template_ref const, T>(fn, e);
+    case check_expr_kind:         return invoke_as<Check_expr const, T>(fn, e);
+    case add_expr_kind:           return invoke_as<Add_expr const, T>(fn, e);
+    case sub_expr_kind:           return invoke_as<Sub_expr const, T>(fn, e);
+    case mul_expr_kind:           return invoke_as<Mul_expr const, T>(fn, e);
+    case div_expr_kind:           return invoke_as<Div_expr const, T>(fn, e);
+    case rem_expr_kind:           return invoke_as<Rem_expr const, T>(fn, e);
+    case neg_expr_kind:           return invoke_as<Neg_expr const, T>(fn, e);
+    case pos_expr_kind:           return invoke_as<Pos_expr const, T>(fn, e);
+    case eq_expr_kind:            return invoke_as<Eq_expr const, T>(fn, e);
+    case ne_expr_kind:            return invoke_as<Ne_expr const, T>(fn, e);
+    case lt_expr_kind:            return invoke_as<Lt_expr const, T>(fn, e);
+    case gt_expr_kind:            return invoke_as<Gt_expr const, T>(fn, e);
+    case le_expr_kind:            return invoke_as<Le_expr const, T>(fn, e);
+    case ge_expr_kind:            return invoke_as<Ge_expr const, T>(fn, e);
+    case and_expr_kind:           return invoke_as<And_expr const, T>(fn, e);
+    case or_expr_kind:            return invoke_as<Or_expr const, T>(fn, e);
+    case not_expr_kind:           return invoke_as<Not_expr const, T>(fn, e);
+    case call_expr_kind:          return invoke_as<Call_expr const, T>(fn, e);
+    case assign_expr_kind:        return invoke_as<Assign_expr const, T>(fn, e);
+    case requires_expr_kind:      return invoke_as<Requires_expr const, T>(fn, e);
+    case synthetic_expr_kind:     return invoke_as<Synthetic_expr const, T>(fn, e);
+    case value_conv_kind:         return invoke_as<Value_conv const, T>(fn, e);
+    case qualification_conv_kind: return invoke_as<Qualification_conv const, T>(fn, e);
+    case boolean_conv_kind:       return invoke_as<Boolean_conv const, T>(fn, e);
+    case integer_conv_kind:       return invoke_as<Integer_conv const, T>(fn, e);
+    case float_conv_kind:         return invoke_as<Float_conv const, T>(fn, e);
+    case numeric_conv_kind:       return invoke_as<Numeric_conv const, T>(fn, e);
+    case dependent_conv_kind:     return invoke_as<Dependent_conv const, T>(fn, e);
+    case ellipsis_conv_kind:      return invoke_as<Ellipsis_conv const, T>(fn, e);
+    case trivial_init_kind:       return invoke_as<Trivial_init const, T>(fn, e);
+    case copy_init_kind:          return invoke_as<Copy_init const, T>(fn, e);
+    case bind_init_kind:          return invoke_as<Bind_init const, T>(fn, e);
+    case direct_init_kind:        return invoke_as<Direct_init const, T>(fn, e);
+    case aggregate_init_kind:     return invoke_as<Aggregate_init const, T>(fn, e);
+    default: break;
+  }
+#endif
   Generic_expr_visitor<F, T> vis(fn);
   return accept(e, vis);
 }
@@ -921,11 +1015,57 @@ struct Generic_expr_mutator : Expr::Mutator, Generic_mutator<F, T>
 };
 
 
-// Apply a function to the given type.
+// Apply a function to the given expression. This dispatches on the kind
+// of e instead of calling through the mutator. Kinds without a case
+// fall back to the mutator.
 template<typename F, typename T = typename std::result_of<F(Boolean_expr&)>::type>
-inline decltype(auto)
+inline T
 apply(Expr& e, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(e)) {
+    case boolean_expr_kind:       return invoke_as<Boolean_expr, T>(fn, e);
+    case integer_expr_kind:       return invoke_as<Integer_expr, T>(fn, e);
+    case real_expr_kind:          return invoke_as<Real_expr, T>(fn, e);
+    case reference_expr_kind:     return invoke_as<Reference_expr, T>(fn, e);
+    case template_ref_kind:       return invoke_as<Template_ref, T>(fn, e);
+    case check_expr_kind:         return invoke_as<Check_expr, T>(fn, e);
+    case add_expr_kind:           return invoke_as<Add_expr, T>(fn, e);
+    case sub_expr_kind:           return invoke_as<Sub_expr, T>(fn, e);
+    case mul_expr_kind:           return invoke_as<Mul_expr, T>(fn, e);
+    case div_expr_kind:           return invoke_as<Div_expr, T>(fn, e);
+    case rem_expr_kind:           return invoke_as<Rem_expr, T>(fn, e);
+    case neg_expr_kind:           return invoke_as<Neg_expr, T>(fn, e);
+    case pos_expr_kind:           return invoke_as<Pos_expr, T>(fn, e);
+    case eq_expr_kind:            return invoke_as<Eq_expr, T>(fn, e);
+    case ne_expr_kind:            return invoke_as<Ne_expr, T>(fn, e);
+    case lt_expr_kind:            return invoke_as<Lt_expr, T>(fn, e);
+    case gt_expr_kind:            return invoke_as<Gt_expr, T>(fn, e);
+    case le_expr_kind:            return invoke_as<Le_expr, T>(fn, e);
+    case ge_expr_kind:            return invoke_as<Ge_expr, T>(fn, e);
+    case and_expr_kind:           return invoke_as<And_expr, T>(fn, e);
+    case or_expr_kind:            return invoke_as<Or_expr, T>(fn, e);
+    case not_expr_kind:           return invoke_as<Not_expr, T>(fn, e);
+    case call_expr_kind:          return invoke_as<Call_expr, T>(fn, e);
+    case assign_expr_kind:        return invoke_as<Assign_expr, T>(fn, e);
+    case requires_expr_kind:      return invoke_as<Requires_expr, T>(fn, e);
+    case synthetic_expr_kind:     return invoke_as<Synthetic_expr, T>(fn, e);
+    case value_conv_kind:         return invoke_as<Value_conv, T>(fn, e);
+    case qualification_conv_kind: return invoke_as<Qualification_conv, T>(fn, e);
+    case boolean_conv_kind:       return invoke_as<Boolean_conv, T>(fn, e);
+    case integer_conv_kind:       return invoke_as<Integer_conv, T>(fn, e);
+    case float_conv_kind:         return invoke_as<Float_conv, T>(fn, e);
+    case numeric_conv_kind:       return invoke_as<Numeric_conv, T>(fn, e);
+    case dependent_conv_kind:     return invoke_as<Dependent_conv, T>(fn, e);
+    case ellipsis_conv_kind:      return invoke_as<Ellipsis_conv, T>(fn, e);
+    case trivial_init_kind:       return invoke_as<Trivial_init, T>(fn, e);
+    case copy_init_kind:          return invoke_as<Copy_init, T>(fn, e);
+    case bind_init_kind:          return invoke_as<Bind_init, T>(fn, e);
+    case direct_init_kind:        return invoke_as<Direct_init, T>(fn, e);
+    case aggregate_init_kind:     return invoke_as<Aggregate_init, T>(fn, e);
+    default: break;
+  }
+#endif
   Generic_expr_mutator<F, T> vis(fn);
   return accept(e, vis);
 }
@@ -67,6 +67,7 @@ struct Simple_id : Name
 
   void accept(Visitor& v) const { v.visit(*this); };
   void accept(Mutator& v)       { v.visit(*this); };
+  Term_kind term_kind() const { return Term_kinds<Simple_id>::first; }
 
   Symbol const& symbol() const { return *first; }
 
@@ -84,6 +85,7 @@ struct Global_id : Name
 
   void accept(Visitor& v) const { v.visit(*this); };
   void accept(Mutator& v)       { v.visit(*this); };
+  Term_kind term_kind() const { return Term_kinds<Global_id>::first; }
 };
 
 
@@ -99,6 +101,7 @@ struct Placeholder_id : Name
 
   void accept(Visitor& v) const { v.visit(*this); };
   void accept(Mutator& v)       { v.visit(*this); };
+  Term_kind term_kind() const { return Term_kinds<Placeholder_id>::first; }
 
   int number() const { return num; }
 
@@ -117,6 +120,7 @@ struct Operator_id : Name
 
   void accept(Visitor& v) const { v.visit(*this); };
   void accept(Mutator& v)       { v.visit(*this); };
+  Term_kind term_kind() const { return Term_kinds<Operator_id>::first; }
 
   // Returns the operator kind.
   Operator_kind kind() const { return op; }
@@ -132,6 +136,7 @@ struct Conversion_id : Name
 {
   void accept(Visitor& v) const { v.visit(*this); };
   void accept(Mutator& v)       { v.visit(*this); };
+  Term_kind term_kind() const { return Term_kinds<Conversion_id>::first; }
 };
 
 
@@ -142,6 +147,7 @@ struct Literal_id : Name
 {
   void accept(Visitor& v) const { v.visit(*this); };
   void accept(Mutator& v)       { v.visit(*this); };
+  Term_kind term_kind() const { return Term_kinds<Literal_id>::first; }
 };
 
 
@@ -149,6 +155,7 @@ struct Literal_id : Name
 struct Destructor_id : Name
 {
   void accept(Mutator& v)       { v.visit(*this); };
+  Term_kind term_kind() const { return Term_kinds<Destructor_id>::first; }
   void accept(Visitor& v) const { v.visit(*this); };
 
   // Returns the type named by the destructor id.
@@ -175,6 +182,7 @@ struct Template_id : Name
 
   void accept(Visitor& v) const { v.visit(*this); };
   void accept(Mutator& v)       { v.visit(*this); };
+  Term_kind term_kind() const { return Term_kinds<Template_id>::first; }
 
   Template_decl const& declaration() const;
   Template_decl&       declaration();
@@ -200,6 +208,7 @@ struct Concept_id : Name
 
   void accept(Visitor& v) const { v.visit(*this); };
   void accept(Mutator& v)       { v.visit(*this); };
+  Term_kind term_kind() const { return Term_kinds<Concept_id>::first; }
 
   Concept_decl const& declaration() const;
   Concept_decl&       declaration();
@@ -230,6 +239,7 @@ struct Qualified_id : Name
 
   void accept(Visitor& v) const { v.visit(*this); };
   void accept(Mutator& v)       { v.visit(*this); };
+  Term_kind term_kind() const { return Term_kinds<Qualified_id>::first; }
 
   // Returns the qualifying scope (the enclosing declaration)
   // for the unqualified id.
@@ -270,11 +280,28 @@ struct Generic_name_visitor : Name::Visitor, Generic_visitor<F, T>
 };
 
 
-// Apply a function to the given name.
+// Apply a function to the given name. This dispatches on the kind
+// of n instead of calling through the visitor. Kinds without a case
+// fall back to the visitor.
 template<typename F, typename T = typename std::result_of<F(Simple_id const&)>::type>
-inline decltype(auto)
+inline T
 apply(Name const& n, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(n)) {
+    case simple_id_kind:      return invoke_as<Simple_id const, T>(fn, n);
+    case global_id_kind:      return invoke_as<Global_id const, T>(fn, n);
+    case placeholder_id_kind: return invoke_as<Placeholder_id const, T>(fn, n);
+    case operator_id_kind:    return invoke_as<Operator_id const, T>(fn, n);
+    case conversion_id_kind:  return invoke_as<Conversion_id const, T>(fn, n);
+    case literal_id_kind:     return invoke_as<Literal_id const, T>(fn, n);
+    case destructor_id_kind:  return invoke_as<Destructor_id const, T>(fn, n);
+    case template_id_kind:    return invoke_as<Template_id const, T>(fn, n);
+    case concept_id_kind:     return invoke_as<Concept_id const, T>(fn, n);
+    case qualified_id_kind:   return invoke_as<Qualified_id const, T>(fn, n);
+    default: break;
+  }
+#endif
   Generic_name_visitor<F, T> vis(fn);
   return accept(n, vis);
 }
@@ -301,11 +328,28 @@ struct Generic_name_mutator : Name::Mutator, Generic_mutator<F, T>
 };
 
 
-// Apply a function to the given name.
+// Apply a function to the given name. This dispatches on the kind
+// of n instead of calling through the mutator. Kinds without a case
+// fall back to the mutator.
 template<typename F, typename T = typename std::result_of<F(Simple_id&)>::type>
-inline decltype(auto)
+inline T
 apply(Name& n, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(n)) {
+    case simple_id_kind:      return invoke_as<Simple_id, T>(fn, n);
+    case global_id_kind:      return invoke_as<Global_id, T>(fn, n);
+    case placeholder_id_kind: return invoke_as<Placeholder_id, T>(fn, n);
+    case operator_id_kind:    return invoke_as<Operator_id, T>(fn, n);
+    case conversion_id_kind:  return invoke_as<Conversion_id, T>(fn, n);
+    case literal_id_kind:     return invoke_as<Literal_id, T>(fn, n);
+    case destructor_id_kind:  return invoke_as<Destructor_id, T>(fn, n);
+    case template_id_kind:    return invoke_as<Template_id, T>(fn, n);
+    case concept_id_kind:     return invoke_as<Concept_id, T>(fn, n);
+    case qualified_id_kind:   return invoke_as<Qualified_id, T>(fn, n);
+    default: break;
+  }
+#endif
   Generic_name_mutator<F, T> vis(fn);
   return accept(n, vis);
 }
@@ -65,6 +65,7 @@ struct Type_req : Req
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Type_req>::first; }
 
   // Returns the form of the type required.
   Type const& type() const { return *ty; }
@@ -85,6 +86,7 @@ struct Syntactic_req : Req
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Syntactic_req>::first; }
 
   Expr const& expression() const { return *req; }
   Expr&       expression()       { return *req; }
@@ -100,6 +102,7 @@ struct Semantic_req : Req
 {
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Semantic_req>::first; }
 
   Decl const& declaration() const { return *decl; }
   Decl&       declaration()       { return *decl; }
@@ -114,6 +117,7 @@ struct Expression_req : Req
 {
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Expression_req>::first; }
 
   Expr const& expression() const { return *expr; }
   Expr&       expression()       { return *expr; }
@@ -131,6 +135,7 @@ struct Basic_req : Req
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Basic_req>::first; }
 
   // Returns the required expression.
   Expr const& expression() const { return *expr; }
@@ -154,6 +159,7 @@ struct Conversion_req : Req
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Conversion_req>::first; }
 
   Expr const& expression() const { return *expr; }
   Expr&       expression()       { return *expr; }
@@ -178,6 +184,7 @@ struct Deduction_req : Req
 {
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Deduction_req>::first; }
 
   Expr const& expression() const { return *expr; }
   Expr&       expression()       { return *expr; }
@@ -208,11 +215,25 @@ struct Generic_req_visitor : Req::Visitor, Generic_visitor<F, T>
 };
 
 
-// Apply a function to the given type.
+// Apply a function to the given requirement. This dispatches on the kind
+// of r instead of calling through the visitor. Kinds without a case
+// fall back to the visitor.
 template<typename F, typename T = typename std::result_of<F(Type_req const&)>::type>
 inline T
 apply(Req const& r, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(r)) {
+    case type_req_kind:       return invoke_as<Type_req const, T>(fn, r);
+    case syntactic_req_kind:  return invoke_as<Syntactic_req const, T>(fn, r);
+    case semantic_req_kind:   return invoke_as<Semantic_req const, T>(fn, r);
+    case expression_req_kind: return invoke_as<Expression_req const, T>(fn, r);
+    case basic_req_kind:      return invoke_as<Basic_req const, T>(fn, r);
+    case conversion_req_kind: return invoke_as<Conversion_req const, T>(fn, r);
+    case deduction_req_kind:  return invoke_as<Deduction_req const, T>(fn, r);
+    default: break;
+  }
+#endif
   Generic_req_visitor<F, T> vis(fn);
   return accept(r, vis);
 }
@@ -236,11 +257,25 @@ struct Generic_req_mutator : Req::Mutator, Generic_mutator<F, T>
 };
 
 
-// Apply a function to the given type.
+// Apply a function to the given requirement. This dispatches on the kind
+// of r instead of calling through the mutator. Kinds without a case
+// fall back to the mutator.
 template<typename F, typename T = typename std::result_of<F(Type_req&)>::type>
 inline T
 apply(Req& r, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(r)) {
+    case type_req_kind:       return invoke_as<Type_req, T>(fn, r);
+    case syntactic_req_kind:  return invoke_as<Syntactic_req, T>(fn, r);
+    case semantic_req_kind:   return invoke_as<Semantic_req, T>(fn, r);
+    case expression_req_kind: return invoke_as<Expression_req, T>(fn, r);
+    case basic_req_kind:      return invoke_as<Basic_req, T>(fn, r);
+    case conversion_req_kind: return invoke_as<Conversion_req, T>(fn, r);
+    case deduction_req_kind:  return invoke_as<Deduction_req, T>(fn, r);
+    default: break;
+  }
+#endif
   Generic_req_mutator<F, T> vis(fn);
   return accept(r, vis);
 }
@@ -40,6 +40,7 @@ struct Compound_stmt : Stmt
   { }
 
   void accept(Visitor& v) const { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Compound_stmt>::first; }
 
   Stmt_list const& statements() const { return stmts; }
   Stmt_list&       statements()       { return stmts; }
@@ -57,6 +58,7 @@ struct Expression_stmt : Stmt
   { }
 
   void accept(Visitor& v) const { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Expression_stmt>::first; }
 
   // Returns the expression of the statement.
   Expr const& expression() const { return *expr; }
@@ -74,6 +76,7 @@ struct Declaration_stmt : Stmt
   { }
 
   void accept(Visitor& v) const { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Declaration_stmt>::first; }
 
   // Returns the declaration of the statement.
   Decl const& declaration() const { return *decl; }
@@ -91,6 +94,7 @@ struct Return_stmt : Stmt
   { }
 
   void accept(Visitor& v) const { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Return_stmt>::first; }
 
   // Returns the expression returned by the statement.
   Expr const& expression() const { return *expr; }
@@ -115,11 +119,22 @@ struct Generic_stmt_visitor : Stmt::Visitor, Generic_visitor<F, T>
 };
 
 
-// Apply a function to the given type.
+// Apply a function to the given statement. This dispatches on the kind
+// of s instead of calling through the visitor. Kinds without a case
+// fall back to the visitor.
 template<typename F, typename T = typename std::result_of<F(Return_stmt const&)>::type>
 inline T
 apply(Stmt const& s, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(s)) {
+    case compound_stmt_kind:    return invoke_as<Compound_stmt const, T>(fn, s);
+    case expression_stmt_kind:  return invoke_as<Expression_stmt const, T>(fn, s);
+    case declaration_stmt_kind: return invoke_as<Declaration_stmt const, T>(fn, s);
+    case return_stmt_kind:      return invoke_as<Return_stmt const, T>(fn, s);
+    default: break;
+  }
+#endif
   Generic_stmt_visitor<F, T> vis(fn);
   return accept(s, vis);
 }
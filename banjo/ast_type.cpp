@@ -81,40 +81,42 @@ Typename_type::declaration()
 // -------------------------------------------------------------------------- //
 // Dependent types
 
-inline bool
-any_dependent_type(Type_list const& ts)
-{
-  return std::any_of(ts.begin(), ts.end(), is_dependent_type);
-}
-
-
-inline bool
-is_dependent_function_type(Function_type const& t)
+// Compute the dependence of `t` from that of its components, which
+// is already known. Returns `t`.
+//
+// TODO: This implementation is not yet complete. It doesn't handle,
+// e.g., dependent template specializations, dependent members, etc.
+Type&
+set_dependence(Type& t)
 {
-  return any_dependent_type(t.parameter_types())
-      || is_dependent_type(t.return_type());
+  struct fn
+  {
+    int operator()(Type const& t)           { return 0; }
+    int operator()(Qualified_type const& t) { return t.type().dep; }
+    int operator()(Reference_type const& t) { return t.type().dep; }
+    int operator()(Pointer_type const& t)   { return t.type().dep; }
+    int operator()(Array_type const& t)     { return t.type().dep; }
+    int operator()(Sequence_type const& t)  { return t.type().dep; }
+    int operator()(Typename_type const& t)  { return dependent_flags; }
+
+    int operator()(Function_type const& t)
+    {
+      int d = t.return_type().dep;
+      for (Type const& p : t.parameter_types())
+        d |= p.dep;
+      return d;
+    }
+  };
+  t.dep = apply(t, fn{});
+  return t;
 }
 
 
 // Returns true if `t` is dependent.
-//
-// TODO: This implementation is not yet complete. It doesn't handle,
-// e.g., dependent template specializations, dependent members, etc.
 bool
 is_dependent_type(Type const& t)
 {
-  struct fn
-  {
-    bool operator()(Type const& t)           { return false; }
-    bool operator()(Function_type const& t)  { return is_dependent_function_type(t); }
-    bool operator()(Qualified_type const& t) { return is_dependent_type(t.type()); }
-    bool operator()(Reference_type const& t) { return is_dependent_type(t.type()); }
-    bool operator()(Pointer_type const& t)   { return is_dependent_type(t.type()); }
-    bool operator()(Array_type const& t)     { return is_dependent_type(t.type()); }
-    bool operator()(Sequence_type const& t)  { return is_dependent_type(t.type()); }
-    bool operator()(Typename_type const& t)  { return true; }
-  };
-  return apply(t, fn{});
+  return t.is_dependent();
 }
 
 
@@ -33,6 +33,20 @@ struct Type : Term
   // Returns the non-reference version of this type.
   virtual Type const& non_reference_type() const { return *this; }
   virtual Type&       non_reference_type()       { return *this; }
+
+  // Returns true if this is the unique representation of the type.
+  // Distinct canonical types are never equivalent. Canonical types
+  // are created by the builder.
+  bool is_canonical() const { return canon; }
+
+  // Returns true if this type depends on a template parameter.
+  bool is_dependent() const { return dep & type_dependent_flag; }
+
+  // Returns true if substitution can change this type.
+  bool contains_parameters() const { return dep & contains_parameter_flag; }
+
+  bool          canon = false;
+  unsigned char dep = 0;
 };
 
 
@@ -89,6 +103,7 @@ struct Void_type : Type
 {
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Void_type>::first; }
 };
 
 
@@ -97,6 +112,7 @@ struct Boolean_type : Type
 {
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Boolean_type>::first; }
 };
 
 
@@ -114,6 +130,7 @@ struct Integer_type : Type
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Integer_type>::first; }
 
   bool sign() const        { return sgn; }
   bool is_signed() const   { return sgn; }
@@ -131,6 +148,7 @@ struct Byte_type : Type
 {
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Byte_type>::first; }
 };
 
 
@@ -143,6 +161,7 @@ struct Float_type : Type
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Float_type>::first; }
 
   int precision() const { return prec; }
 
@@ -180,6 +199,7 @@ struct Auto_type : Type
 {
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Auto_type>::first; }
 };
 
 
@@ -188,6 +208,7 @@ struct Decltype_type : Type
 {
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Decltype_type>::first; }
 };
 
 
@@ -196,6 +217,7 @@ struct Declauto_type : Type
 {
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Declauto_type>::first; }
 };
 
 
@@ -208,6 +230,7 @@ struct Function_type : Type
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Function_type>::first; }
 
   Type_list const& parameter_types() const { return parms; }
   Type_list&       parameter_types()       { return parms; }
@@ -231,6 +254,7 @@ struct Qualified_type : Type
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Qualified_type>::first; }
 
   Type const& type() const { return *ty; }
   Type&       type()       { return *ty; }
@@ -258,6 +282,7 @@ struct Pointer_type : Type
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Pointer_type>::first; }
 
   Type const& type() const { return *ty; }
   Type&       type()       { return *ty; }
@@ -274,6 +299,7 @@ struct Reference_type : Type
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Reference_type>::first; }
 
   Type const& type() const { return *ty; }
   Type&       type()       { return *ty; }
@@ -290,6 +316,7 @@ struct Array_type : Type
 {
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Array_type>::first; }
 
   Type const& type() const { return *ty; }
   Type&       type()       { return *ty; }
@@ -312,6 +339,7 @@ struct Sequence_type : Type
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Sequence_type>::first; }
 
   Type const& type() const { return *ty; }
   Type&       type()       { return *ty; }
@@ -352,6 +380,7 @@ struct Class_type : User_defined_type
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Class_type>::first; }
 
   // Returns the declaration of the class type.
   Class_decl const& declaration() const;
@@ -365,6 +394,7 @@ struct Union_type : User_defined_type
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Union_type>::first; }
 
   // Returns the declaration of the union type.
   Union_decl const& declaration() const;
@@ -378,6 +408,7 @@ struct Enum_type : User_defined_type
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Enum_type>::first; }
 
   // Returns the declaration of the enum type.
   Enum_decl const& declaration() const;
@@ -394,6 +425,7 @@ struct Typename_type : User_defined_type
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Typename_type>::first; }
 
   // Returns the declaration of the typename type.
   Type_parm const& declaration() const;
@@ -412,6 +444,7 @@ struct Synthetic_type : User_defined_type
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
+  Term_kind term_kind() const { return Term_kinds<Synthetic_type>::first; }
 };
 
 
@@ -427,7 +460,7 @@ struct Synthetic_type : User_defined_type
 inline bool
 is_boolean_type(Type const& t)
 {
-  return is<Boolean_type>(&t);
+  return isa<Boolean_type>(t);
 }
 
 
@@ -435,7 +468,7 @@ is_boolean_type(Type const& t)
 inline bool
 is_integer_type(Type const& t)
 {
-  return is<Integer_type>(&t);
+  return isa<Integer_type>(t);
 }
 
 
@@ -443,7 +476,7 @@ is_integer_type(Type const& t)
 inline bool
 is_floating_point_type(Type const& t)
 {
-  return is<Float_type>(&t);
+  return isa<Float_type>(t);
 }
 
 
@@ -451,7 +484,7 @@ is_floating_point_type(Type const& t)
 inline bool
 is_function_type(Type const& t)
 {
-  return is<Function_type>(&t);
+  return isa<Function_type>(t);
 }
 
 
@@ -459,7 +492,7 @@ is_function_type(Type const& t)
 inline bool
 is_reference_type(Type const& t)
 {
-  return is<Reference_type>(&t);
+  return isa<Reference_type>(t);
 }
 
 
@@ -467,7 +500,7 @@ is_reference_type(Type const& t)
 inline bool
 is_pointer_type(Type const& t)
 {
-  return is<Pointer_type>(&t);
+  return isa<Pointer_type>(t);
 }
 
 
@@ -475,7 +508,7 @@ is_pointer_type(Type const& t)
 inline bool
 is_array_type(Type const& t)
 {
-  return is<Array_type>(&t);
+  return isa<Array_type>(t);
 }
 
 
@@ -483,7 +516,7 @@ is_array_type(Type const& t)
 inline bool
 is_sequence_type(Type const& t)
 {
-  return is<Sequence_type>(&t);
+  return isa<Sequence_type>(t);
 }
 
 
@@ -491,7 +524,7 @@ is_sequence_type(Type const& t)
 inline bool
 is_class_type(Type const& t)
 {
-  return is<Class_type>(&t);
+  return isa<Class_type>(t);
 }
 
 
@@ -507,7 +540,7 @@ is_maybe_qualified_class_type(Type const& t)
 inline bool
 is_union_type(Type const& t)
 {
-  return is<Union_type>(&t);
+  return isa<Union_type>(t);
 }
 
 
@@ -532,7 +565,8 @@ is_scalar_type(Type const& t)
 
 
 bool is_object_type(Type const&);
-bool is_dependent_type(Type const&);
+bool  is_dependent_type(Type const&);
+Type& set_dependence(Type&);
 
 
 // -------------------------------------------------------------------------- //
@@ -568,11 +602,36 @@ struct Generic_type_visitor : Type::Visitor, Generic_visitor<F, T>
 };
 
 
-// Apply a function to the given type.
+// Apply a function to the given type. This dispatches on the kind
+// of t instead of calling through the visitor. Kinds without a case
+// fall back to the visitor.
 template<typename F, typename T = typename std::result_of<F(Void_type const&)>::type>
-inline decltype(auto)
+inline T
 apply(Type const& t, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(t)) {
+    case void_type_kind:      return invoke_as<Void_type const, T>(fn, t);
+    case boolean_type_kind:   return invoke_as<Boolean_type const, T>(fn, t);
+    case integer_type_kind:   return invoke_as<Integer_type const, T>(fn, t);
+    case float_type_kind:     return invoke_as<Float_type const, T>(fn, t);
+    case auto_type_kind:      return invoke_as<Auto_type const, T>(fn, t);
+    case decltype_type_kind:  return invoke_as<Decltype_type const, T>(fn, t);
+    case declauto_type_kind:  return invoke_as<Declauto_type const, T>(fn, t);
+    case function_type_kind:  return invoke_as<Function_type const, T>(fn, t);
+    case qualified_type_kind: return invoke_as<Qualified_type const, T>(fn, t);
+    case pointer_type_kind:   return invoke_as<Pointer_type const, T>(fn, t);
+    case reference_type_kind: return invoke_as<Reference_type const, T>(fn, t);
+    case array_type_kind:     return invoke_as<Array_type const, T>(fn, t);
+    case sequence_type_kind:  return invoke_as<Sequence_type const, T>(fn, t);
+    case class_type_kind:     return invoke_as<Class_type const, T>(fn, t);
+    case union_type_kind:     return invoke_as<Union_type const, T>(fn, t);
+    case enum_type_kind:      return invoke_as<Enum_type const, T>(fn, t);
+    case typename_type_kind:  return invoke_as<Typename_type const, T>(fn, t);
+    case synthetic_type_kind: return invoke_as<Synthetic_type const, T>(fn, t);
+    default: break;
+  }
+#endif
   Generic_type_visitor<F, T> vis(fn);
   return accept(t, vis);
 }
@@ -607,11 +666,36 @@ struct Generic_type_mutator : Type::Mutator, Generic_mutator<F, T>
 };
 
 
-// Apply a function to the given type.
+// Apply a function to the given type. This dispatches on the kind
+// of t instead of calling through the mutator. Kinds without a case
+// fall back to the mutator.
 template<typename F, typename T = typename std::result_of<F(Void_type&)>::type>
-inline decltype(auto)
+inline T
 apply(Type& t, F fn)
 {
+#ifndef BANJO_VIRTUAL_DISPATCH
+  switch (kind_of(t)) {
+    case void_type_kind:      return invoke_as<Void_type, T>(fn, t);
+    case boolean_type_kind:   return invoke_as<Boolean_type, T>(fn, t);
+    case integer_type_kind:   return invoke_as<Integer_type, T>(fn, t);
+    case float_type_kind:     return invoke_as<Float_type, T>(fn, t);
+    case auto_type_kind:      return invoke_as<Auto_type, T>(fn, t);
+    case decltype_type_kind:  return invoke_as<Decltype_type, T>(fn, t);
+    case declauto_type_kind:  return invoke_as<Declauto_type, T>(fn, t);
+    case function_type_kind:  return invoke_as<Function_type, T>(fn, t);
+    case qualified_type_kind: return invoke_as<Qualified_type, T>(fn, t);
+    case pointer_type_kind:   return invoke_as<Pointer_type, T>(fn, t);
+    case reference_type_kind: return invoke_as<Reference_type, T>(fn, t);
+    case array_type_kind:     return invoke_as<Array_type, T>(fn, t);
+    case sequence_type_kind:  return invoke_as<Sequence_type, T>(fn, t);
+    case class_type_kind:     return invoke_as<Class_type, T>(fn, t);
+    case union_type_kind:     return invoke_as<Union_type, T>(fn, t);
+    case enum_type_kind:      return invoke_as<Enum_type, T>(fn, t);
+    case typename_type_kind:  return invoke_as<Typename_type, T>(fn, t);
+    case synthetic_type_kind: return invoke_as<Synthetic_type, T>(fn, t);
+    default: break;
+  }
+#endif
   Generic_type_mutator<F, T> vis(fn);
   return accept(t, vis);
 }
@@ -7,62 +7,12 @@
 #include "equivalence.hpp"
 #include "hash.hpp"
 
-#include <unordered_set>
+#include <boost/functional/hash.hpp>
 
 
 namespace banjo
 {
 
-// FIXME: Move this into lingo.
-//
-// A unique factory will only allocate new objects if they have not been
-// previously created.
-template<typename T, typename Hash, typename Eq>
-struct Hashed_unique_factory : std::unordered_set<T, Hash, Eq>
-{
-  template<typename... Args>
-  T& make(Args&&... args)
-  {
-    auto ins = this->emplace(std::forward<Args>(args)...);
-    return *const_cast<T*>(&*ins.first); // Yuck.
-  }
-};
-
-
-template<typename T>
-struct Hash
-{
-  std::size_t operator()(T const& t) const
-  {
-    return hash_value(t);
-  }
-
-  std::size_t operator()(List<T> const& t) const
-  {
-    return hash_value(t);
-  }
-};
-
-
-template<typename T>
-struct Eq
-{
-  bool operator()(T const& a, T const& b) const
-  {
-    return is_equivalent(a, b);
-  }
-
-  bool operator()(List<T> const& a, List<T> const& b) const
-  {
-    return is_equivalent(a, b);
-  }
-};
-
-
-template<typename T>
-using Factory = Hashed_unique_factory<T, Hash<T>, Eq<T>>;
-
-
 // -------------------------------------------------------------------------- //
 // Builder definition
 
@@ -73,14 +23,16 @@ Builder::symbols() { return cxt.symbols(); }
 // -------------------------------------------------------------------------- //
 // Names
 
+// Simple identifiers and operator ids are unique within a context,
+// so names can be compared by identity.
+
+
 // Returns a simple identifier with the given spelling.
-//
-// TODO: Unique this?
 Simple_id&
 Builder::get_id(char const* s)
 {
   Symbol const* sym = symbols().put_identifier(identifier_tok, s);
-  return make<Simple_id>(*sym);
+  return get_id(*sym);
 }
 
 
@@ -89,16 +41,16 @@ Simple_id&
 Builder::get_id(std::string const& s)
 {
   Symbol const* sym = symbols().put_identifier(identifier_tok, s);
-  return make<Simple_id>(*sym);
+  return get_id(*sym);
 }
 
 
-// Returns a simple identifier for the given symbol.
+// Returns the simple identifier for the given symbol.
 Simple_id&
 Builder::get_id(Symbol const& sym)
 {
   lingo_assert(is<Identifier_sym>(&sym));
-  return make<Simple_id>(sym);
+  return cxt.ids.make<Simple_id>(cxt.arena, sym);
 }
 
 
@@ -131,7 +83,7 @@ Builder::get_id()
 Operator_id&
 Builder::get_id(Operator_kind k)
 {
-  return make<Operator_id>(k);
+  return cxt.ids.make<Operator_id>(cxt.arena, k);
 }
 
 
@@ -169,39 +121,163 @@ Builder::get_qualified_id(Decl& d, Name& n)
 Global_id&
 Builder::get_global_id()
 {
-  // TODO: Global or no?
-  static Global_id n;
-  return n;
+  if (!cxt.gid)
+    cxt.gid = &make<Global_id>();
+  return *cxt.gid;
 }
 
 
 // -------------------------------------------------------------------------- //
 // Types
+//
+// Types are hash-consed: each structurally distinct type is created
+// once per context and marked canonical, so that type equivalence is
+// an identity comparison. A type whose components are not canonical
+// (e.g., they were allocated outside of the builder) is still shared,
+// but not marked canonical.
+//
+// Placeholder and synthetic types are never shared. Each one is a
+// distinct type, so they are canonical by construction.
+
+
+std::size_t
+Canonical_type_hash::operator()(Type const* t) const
+{
+  struct fn
+  {
+    std::size_t operator()(Type const& t) const           { return 0; }
+    std::size_t operator()(Integer_type const& t) const   { return boost::hash_value(std::make_pair(t.sign(), t.precision())); }
+    std::size_t operator()(Float_type const& t) const     { return boost::hash_value(t.precision()); }
+    std::size_t operator()(Qualified_type const& t) const { return boost::hash_value(std::make_pair(&t.type(), (int)t.qualifier())); }
+    std::size_t operator()(Pointer_type const& t) const   { return boost::hash_value(&t.type()); }
+    std::size_t operator()(Reference_type const& t) const { return boost::hash_value(&t.type()); }
+    std::size_t operator()(Sequence_type const& t) const  { return boost::hash_value(&t.type()); }
+    std::size_t operator()(User_defined_type const& t) const { return boost::hash_value(&t.declaration()); }
+
+    std::size_t operator()(Function_type const& t) const
+    {
+      std::size_t h = boost::hash_value(&t.return_type());
+      for (Type const& p : t.parameter_types())
+        boost::hash_combine(h, &p);
+      return h;
+    }
+  };
+
+  std::size_t h = kind_of(*t);
+  boost::hash_combine(h, apply(*t, fn{}));
+  return h;
+}
+
+
+bool
+Canonical_type_eq::operator()(Type const* a, Type const* b) const
+{
+  struct fn
+  {
+    Type const& b;
+
+    bool operator()(Type const& a) const { return true; }
+
+    bool operator()(Integer_type const& a) const
+    {
+      Integer_type const& t = cast<Integer_type>(b);
+      return a.sign() == t.sign() && a.precision() == t.precision();
+    }
+
+    bool operator()(Float_type const& a) const
+    {
+      return a.precision() == cast<Float_type>(b).precision();
+    }
+
+    bool operator()(Function_type const& a) const
+    {
+      Function_type const& t = cast<Function_type>(b);
+      auto same = [](Type const& x, Type const& y) { return &x == &y; };
+      Type_list const& p1 = a.parameter_types();
+      Type_list const& p2 = t.parameter_types();
+      return &a.return_type() == &t.return_type()
+          && std::equal(p1.begin(), p1.end(), p2.begin(), p2.end(), same);
+    }
+
+    bool operator()(Qualified_type const& a) const
+    {
+      Qualified_type const& t = cast<Qualified_type>(b);
+      return &a.type() == &t.type() && a.qualifier() == t.qualifier();
+    }
+
+    bool operator()(Pointer_type const& a) const   { return &a.type() == &cast<Pointer_type>(b).type(); }
+    bool operator()(Reference_type const& a) const { return &a.type() == &cast<Reference_type>(b).type(); }
+    bool operator()(Sequence_type const& a) const  { return &a.type() == &cast<Sequence_type>(b).type(); }
+
+    bool operator()(User_defined_type const& a) const
+    {
+      return &a.declaration() == &cast<User_defined_type>(b).declaration();
+    }
+  };
+
+  if (a == b)
+    return true;
+  if (kind_of(*a) != kind_of(*b))
+    return false;
+  return apply(*a, fn{*b});
+}
+
+
+namespace
+{
+
+// Returns the unique type of kind T constructed over args. The type
+// is marked canonical only when `canon` is true, meaning that all of
+// its components are canonical. Its dependence is computed from
+// that of its components.
+template<typename T, typename... Args>
+inline T&
+get_canonical_type(Context& cxt, bool canon, Args&&... args)
+{
+  T& t = cxt.types.make<T>(cxt.arena, std::forward<Args>(args)...);
+  t.canon = canon;
+  set_dependence(t);
+  return t;
+}
+
+
+// Returns a new type that is distinct from all others.
+template<typename T>
+inline T&
+make_distinct_type(T& t)
+{
+  t.canon = true;
+  return t;
+}
+
+
+} // namespace
+
 
 Void_type&
 Builder::get_void_type()
 {
-  return make<Void_type>();
+  return get_canonical_type<Void_type>(cxt, true);
 }
 
 
 Boolean_type&
 Builder::get_bool_type()
 {
-  return make<Boolean_type>();
+  return get_canonical_type<Boolean_type>(cxt, true);
 }
 
 
 Integer_type&
 Builder::get_integer_type(bool s, int p)
 {
-  return make<Integer_type>(s, p);
+  return get_canonical_type<Integer_type>(cxt, true, s, p);
 }
 
 Byte_type&
 Builder::get_byte_type()
 {
-  return make<Byte_type>();
+  return get_canonical_type<Byte_type>(cxt, true);
 }
 
 
@@ -224,14 +300,14 @@ Builder::get_uint_type()
 Float_type&
 Builder::get_float_type()
 {
-  return make<Float_type>();
+  return get_canonical_type<Float_type>(cxt, true);
 }
 
 
 Auto_type&
 Builder::get_auto_type()
 {
-  return make<Auto_type>();
+  return make_distinct_type(make<Auto_type>());
 }
 
 
@@ -245,7 +321,7 @@ Builder::get_decltype_type(Expr&)
 Declauto_type&
 Builder::get_declauto_type()
 {
-  return make<Declauto_type>();
+  return make_distinct_type(make<Declauto_type>());
 }
 
 
@@ -264,10 +340,16 @@ Builder::get_function_type(Decl_list const& ps, Type& r)
 Function_type&
 Builder::get_function_type(Type_list const& ts, Type& r)
 {
-  return make<Function_type>(ts, r);
+  bool canon = r.is_canonical();
+  for (Type const& t : ts)
+    canon &= t.is_canonical();
+  return get_canonical_type<Function_type>(cxt, canon, ts, r);
 }
 
 
+// Returns the type t qualified by qual. If t is already qualified,
+// the result combines both sets of qualifiers.
+//
 // TODO: Do not build qualified types for functions or arrays.
 // Is that a hard error, or do we simply fold the const into
 // the return type and/or element type?
@@ -275,10 +357,11 @@ Qualified_type&
 Builder::get_qualified_type(Type& t, Qualifier_set qual)
 {
   if (Qualified_type* q = as<Qualified_type>(&t)) {
-    q->qual |= qual;
-    return *q;
+    Qualifier_set qs = q->qualifier();
+    qs |= qual;
+    return get_qualified_type(q->type(), qs);
   }
-  return make<Qualified_type>(t, qual);
+  return get_canonical_type<Qualified_type>(cxt, t.is_canonical(), t, qual);
 }
 
 
@@ -299,14 +382,14 @@ Builder::get_volatile_type(Type& t)
 Pointer_type&
 Builder::get_pointer_type(Type& t)
 {
-  return make<Pointer_type>(t);
+  return get_canonical_type<Pointer_type>(cxt, t.is_canonical(), t);
 }
 
 
 Reference_type&
 Builder::get_reference_type(Type& t)
 {
-  return make<Reference_type>(t);
+  return get_canonical_type<Reference_type>(cxt, t.is_canonical(), t);
 }
 
 
@@ -320,15 +403,14 @@ Builder::get_array_type(Type&, Expr&)
 Sequence_type&
 Builder::get_sequence_type(Type& t)
 {
-  return make<Sequence_type>(t);
+  return get_canonical_type<Sequence_type>(cxt, t.is_canonical(), t);
 }
 
 
-// FIXME: Canonicalize class types?
 Class_type&
 Builder::get_class_type(Decl& d)
 {
-  return make<Class_type>(d);
+  return get_canonical_type<Class_type>(cxt, true, d);
 }
 
 
@@ -349,24 +431,29 @@ Builder::get_enum_type(Decl& d)
 Typename_type&
 Builder::get_typename_type(Decl& d)
 {
-  return make<Typename_type>(d);
+  return get_canonical_type<Typename_type>(cxt, true, d);
 }
 
 
 Synthetic_type&
 Builder::synthesize_type(Decl& d)
 {
-  return make<Synthetic_type>(d);
+  return make_distinct_type(make<Synthetic_type>(d));
 }
 
 
 // -------------------------------------------------------------------------- //
 // Expressions
 
+// Returns the boolean literal with value b. There is exactly one
+// of each per context.
 Boolean_expr&
 Builder::get_bool(bool b)
 {
-  return make<Boolean_expr>(get_bool_type(), b);
+  Boolean_expr*& e = cxt.bools[b];
+  if (!e)
+    e = &make<Boolean_expr>(get_bool_type(), b);
+  return *e;
 }
 
 
@@ -384,12 +471,28 @@ Builder::get_false()
 }
 
 
+// Integer literals in [0, small_integer_limit) with canonical type
+// are shared.
+constexpr int small_integer_limit = 256;
+
+
+// Returns an integer literal with type t and value n.
+//
 // TODO: Verify that T can have an integer value?
 // I think that all scalars can have integer values.
 Integer_expr&
 Builder::get_integer(Type& t, Integer const& n)
 {
-  return make<Integer_expr>(t, n);
+  if (!t.is_canonical() || n < 0 || !(n < small_integer_limit))
+    return make<Integer_expr>(t, n);
+
+  std::vector<Integer_expr*>& lits = cxt.ints[&t];
+  if (lits.empty())
+    lits.resize(small_integer_limit);
+  Integer_expr*& e = lits[n.getu()];
+  if (!e)
+    e = &make<Integer_expr>(t, n);
+  return *e;
 }
 
 
@@ -451,6 +554,15 @@ Builder::make_reference(Object_parm& d)
 }
 
 
+// A value parameter is not an object, so a reference to it is
+// a value of its type.
+Reference_expr&
+Builder::make_reference(Value_parm& d)
+{
+  return make<Reference_expr>(d.type(), d);
+}
+
+
 // Make a concept check. The type is bool.
 Check_expr&
 Builder::make_check(Concept_decl& d, Term_list const& as)
@@ -459,6 +571,55 @@ Builder::make_check(Concept_decl& d, Term_list const& as)
 }
 
 
+Add_expr&
+Builder::make_add(Type& t, Expr& e1, Expr& e2)
+{
+  return make<Add_expr>(t, e1, e2);
+}
+
+
+Sub_expr&
+Builder::make_sub(Type& t, Expr& e1, Expr& e2)
+{
+  return make<Sub_expr>(t, e1, e2);
+}
+
+
+Mul_expr&
+Builder::make_mul(Type& t, Expr& e1, Expr& e2)
+{
+  return make<Mul_expr>(t, e1, e2);
+}
+
+
+Div_expr&
+Builder::make_div(Type& t, Expr& e1, Expr& e2)
+{
+  return make<Div_expr>(t, e1, e2);
+}
+
+
+Rem_expr&
+Builder::make_rem(Type& t, Expr& e1, Expr& e2)
+{
+  return make<Rem_expr>(t, e1, e2);
+}
+
+
+Neg_expr&
+Builder::make_neg(Type& t, Expr& e)
+{
+  return make<Neg_expr>(t, e);
+}
+
+
+Pos_expr&
+Builder::make_pos(Type& t, Expr& e)
+{
+  return make<Pos_expr>(t, e);
+}
+
+
 And_expr&
 Builder::make_and(Type& t, Expr& e1, Expr& e2)
 {
@@ -743,12 +904,14 @@ Builder::make_namespace(char const* s)
 }
 
 
-// FIXME: This should probably be installed on the context.
+// Returns the global namespace. This is created on first use and
+// owned by the context.
 Namespace_decl&
 Builder::get_global_namespace()
 {
-  static Namespace_decl ns(get_global_id());
-  return ns;
+  if (!cxt.global)
+    cxt.global = &make<Namespace_decl>(get_global_id());
+  return *cxt.global;
 }
 
 
@@ -896,62 +1059,66 @@ Builder::make_syntactic_requirement(Expr& e)
 // -------------------------------------------------------------------------- //
 // Constraints
 
-// FIXME: Save all uniqued terms in the context, not as global variables.
+// Assign the next unique id to a newly created constraint. A
+// constraint found by its factory already has an id.
+template<typename T>
+inline T&
+identify(Context& cxt, T& c)
+{
+  if (c.id < 0) {
+    c.id = int(cxt.constraints.size());
+    cxt.constraints.push_back(&c);
+  }
+  return c;
+}
+
 
 Concept_cons&
 Builder::get_concept_constraint(Decl& d, Term_list const& ts)
 {
-  static Factory<Concept_cons> f;
-  return f.make(d, ts);
+  return identify(cxt, cxt.concept_cons.make(cxt.arena, d, ts));
 }
 
 
 Predicate_cons&
 Builder::get_predicate_constraint(Expr& e)
 {
-  static Factory<Predicate_cons> f;
-  return f.make(e);
+  return identify(cxt, cxt.predicate_cons.make(cxt.arena, e));
 }
 
 
 Expression_cons&
 Builder::get_expression_constraint(Expr& e, Type& t)
 {
-  static Factory<Expression_cons> f;
-  return f.make(e, t);
+  return identify(cxt, cxt.expression_cons.make(cxt.arena, e, t));
 }
 
 
 Conversion_cons&
 Builder::get_conversion_constraint(Expr& e, Type& t)
 {
-  static Factory<Conversion_cons> f;
-  return f.make(e, t);
-
+  return identify(cxt, cxt.conversion_cons.make(cxt.arena, e, t));
 }
 
 
 Parameterized_cons&
 Builder::get_parameterized_constraint(Decl_list const& ds, Cons& c)
 {
-  static Factory<Parameterized_cons> f;
-  return f.make(ds, c);
+  return identify(cxt, cxt.parameterized_cons.make(cxt.arena, ds, c));
 }
 
 
 Conjunction_cons&
 Builder::get_conjunction_constraint(Cons& c1, Cons& c2)
 {
-  static Factory<Conjunction_cons> f;
-  return f.make(c1, c2);
+  return identify(cxt, cxt.conjunction_cons.make(cxt.arena, c1, c2));
 }
 
 
 Disjunction_cons&
 Builder::get_disjunction_constraint(Cons& c1, Cons& c2)
 {
-  static Factory<Disjunction_cons> f;
-  return f.make(c1, c2);
+  return identify(cxt, cxt.disjunction_cons.make(cxt.arena, c1, c2));
 }
 
 
@@ -86,8 +86,17 @@ struct Builder
   Reference_expr& make_reference(Function_decl&);
   Template_ref&   make_reference(Template_decl&);
   Reference_expr& make_reference(Object_parm&);
+  Reference_expr& make_reference(Value_parm&);
   Check_expr&     make_check(Concept_decl&, Term_list const&);
 
+  Add_expr&       make_add(Type&, Expr&, Expr&);
+  Sub_expr&       make_sub(Type&, Expr&, Expr&);
+  Mul_expr&       make_mul(Type&, Expr&, Expr&);
+  Div_expr&       make_div(Type&, Expr&, Expr&);
+  Rem_expr&       make_rem(Type&, Expr&, Expr&);
+  Neg_expr&       make_neg(Type&, Expr&);
+  Pos_expr&       make_pos(Type&, Expr&);
+
   And_expr&       make_and(Type&, Expr&, Expr&);
   Or_expr&        make_or(Type&, Expr&, Expr&);
   Not_expr&       make_not(Type&, Expr&);
@@ -175,15 +184,10 @@ struct Builder
   // Resources
   Symbol_table& symbols();
 
-  // Allocate an objet of the given type.
-  //
-  // TODO: This is a placeholder for using a legitimate object
-  // pool in the context (or somewhere else).
+  // Allocate an object of the given type in the context's arena.
+  // This is defined in context.hpp.
   template<typename T, typename... Args>
-  T& make(Args&&... args)
-  {
-    return *new T(std::forward<Args>(args)...);
-  }
+  T& make(Args&&... args);
 
   Context& cxt;
 };
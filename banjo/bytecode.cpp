@@ -0,0 +1,463 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "bytecode.hpp"
+#include "ast.hpp"
+#include "context.hpp"
+#include "evaluation.hpp"
+#include "instantiation.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+
+namespace banjo
+{
+
+// -------------------------------------------------------------------------- //
+// Compilation
+
+namespace
+{
+
+// Thrown by the compiler for terms that it does not support.
+struct Unsupported { };
+
+
+// Compiles expressions and statements into bytecode. Temporaries
+// are allocated in stack order above the parameters; the result of
+// an expression is computed into a given register.
+//
+// Only values are kept in registers. References to parameters are
+// compiled as loads, so functions with parameters or results of
+// reference type are not supported.
+struct Compiler
+{
+  Compiler(Context& c, Bytecode& b)
+    : cxt(c), bc(b), top(b.nparms)
+  {
+    bc.nregs = top;
+  }
+
+  // Allocate a temporary register.
+  int reserve()
+  {
+    int r = top++;
+    bc.nregs = std::max(bc.nregs, top);
+    return r;
+  }
+
+  // Release r and all temporaries allocated after it.
+  void release(int r) { top = r; }
+
+  // Emit an instruction, returning its address.
+  int emit(Opcode op, int a = 0, int b = 0, int c = 0)
+  {
+    bc.code.push_back({op, a, b, c});
+    return int(bc.code.size()) - 1;
+  }
+
+  // Returns the address of the next instruction.
+  int here() const { return int(bc.code.size()); }
+
+  int constant(Value const& v)
+  {
+    bc.consts.push_back(v);
+    return int(bc.consts.size()) - 1;
+  }
+
+  void expression(Expr const&, int);
+  void reference(Reference_expr const&, int);
+  void call(Call_expr const&, int);
+  void unary(Unary_expr const&, Opcode, int);
+  void binary(Binary_expr const&, Opcode, int);
+  void logical(Binary_expr const&, Opcode, int);
+  void conversion(Conv const&, int);
+
+  void statement(Stmt const&);
+
+  Context&  cxt;
+  Bytecode& bc;
+  int       top;
+
+  // Maps parameters to their registers.
+  std::unordered_map<Decl const*, int> parms;
+};
+
+
+void
+Compiler::expression(Expr const& e, int dst)
+{
+  struct fn
+  {
+    Compiler& self;
+    int       dst;
+
+    void operator()(Expr const& e)           { throw Unsupported(); }
+    void operator()(Template_ref const& e)   { throw Unsupported(); }
+    void operator()(Reference_expr const& e) { self.reference(e, dst); }
+    void operator()(Call_expr const& e)      { self.call(e, dst); }
+    void operator()(Conv const& e)           { self.conversion(e, dst); }
+
+    void operator()(Boolean_expr const& e)
+    {
+      self.emit(const_instr, dst, self.constant(e.value()));
+    }
+
+    void operator()(Integer_expr const& e)
+    {
+      self.emit(const_instr, dst, self.constant(Integer_value(e.value().getu())));
+    }
+
+    void operator()(Not_expr const& e) { self.unary(e, not_instr, dst); }
+    void operator()(Neg_expr const& e) { self.unary(e, neg_instr, dst); }
+    void operator()(Pos_expr const& e) { self.expression(e.operand(), dst); }
+
+    void operator()(Add_expr const& e) { self.binary(e, add_instr, dst); }
+    void operator()(Sub_expr const& e) { self.binary(e, sub_instr, dst); }
+    void operator()(Mul_expr const& e) { self.binary(e, mul_instr, dst); }
+    void operator()(Div_expr const& e) { self.binary(e, div_instr, dst); }
+    void operator()(Rem_expr const& e) { self.binary(e, rem_instr, dst); }
+    void operator()(Eq_expr const& e)  { self.binary(e, eq_instr, dst); }
+    void operator()(Ne_expr const& e)  { self.binary(e, ne_instr, dst); }
+    void operator()(Lt_expr const& e)  { self.binary(e, lt_instr, dst); }
+    void operator()(Gt_expr const& e)  { self.binary(e, gt_instr, dst); }
+    void operator()(Le_expr const& e)  { self.binary(e, le_instr, dst); }
+    void operator()(Ge_expr const& e)  { self.binary(e, ge_instr, dst); }
+
+    // The result of && and || is the value of the last evaluated
+    // operand.
+    void operator()(And_expr const& e) { self.logical(e, jump_unless_instr, dst); }
+    void operator()(Or_expr const& e)  { self.logical(e, jump_if_instr, dst); }
+  };
+  apply(e, fn{*this, dst});
+}
+
+
+// A reference to a parameter loads its value. A reference to a
+// function produces that function.
+void
+Compiler::reference(Reference_expr const& e, int dst)
+{
+  Decl const& d = e.declaration();
+  if (Function_decl const* f = as<Function_decl>(&d)) {
+    emit(const_instr, dst, constant(f));
+    return;
+  }
+  auto iter = parms.find(&d);
+  if (iter == parms.end())
+    throw Unsupported();
+  emit(move_instr, dst, iter->second);
+}
+
+
+// Arguments are computed into consecutive registers. Only calls to
+// named functions whose parameters are all values are supported.
+void
+Compiler::call(Call_expr const& e, int dst)
+{
+  Reference_expr const* ref = as<Reference_expr>(&e.function());
+  if (!ref)
+    throw Unsupported();
+  Function_decl const* f = as<Function_decl>(&ref->declaration());
+  if (!f)
+    throw Unsupported();
+
+  Expr_list const& args = e.arguments();
+  Decl_list const& ps = f->parameters();
+  if (args.size() != ps.size())
+    throw Unsupported();
+  for (Decl const& p : ps)
+    if (is<Reference_type>(&declared_type(p)))
+      throw Unsupported();
+
+  int first = top;
+  for (Expr const& a : args)
+    expression(a, reserve());
+  bc.calls.push_back({f, int(args.size()), nullptr});
+  emit(call_instr, dst, int(bc.calls.size()) - 1, first);
+  release(first);
+}
+
+
+void
+Compiler::unary(Unary_expr const& e, Opcode op, int dst)
+{
+  expression(e.operand(), dst);
+  emit(op, dst, dst);
+}
+
+
+void
+Compiler::binary(Binary_expr const& e, Opcode op, int dst)
+{
+  expression(e.left(), dst);
+  int r = reserve();
+  expression(e.right(), r);
+  emit(op, dst, dst, r);
+  release(r);
+}
+
+
+// Compute the left operand into dst, and skip the right operand
+// when the jump is taken.
+void
+Compiler::logical(Binary_expr const& e, Opcode jump, int dst)
+{
+  expression(e.left(), dst);
+  int j = emit(jump, dst);
+  expression(e.right(), dst);
+  bc.code[j].b = here();
+}
+
+
+// Only conversions to bool change the value.
+void
+Compiler::conversion(Conv const& e, int dst)
+{
+  expression(e.source(), dst);
+  if (is<Boolean_conv>(&e))
+    emit(bool_instr, dst, dst);
+}
+
+
+void
+Compiler::statement(Stmt const& s)
+{
+  struct fn
+  {
+    Compiler& self;
+
+    void operator()(Stmt const& s) { throw Unsupported(); }
+
+    void operator()(Compound_stmt const& s)
+    {
+      for (Stmt const& s1 : s.statements())
+        self.statement(s1);
+    }
+
+    void operator()(Expression_stmt const& s)
+    {
+      int r = self.reserve();
+      self.expression(s.expression(), r);
+      self.release(r);
+    }
+
+    void operator()(Return_stmt const& s)
+    {
+      int r = self.reserve();
+      self.expression(s.expression(), r);
+      self.emit(return_instr, r);
+      self.release(r);
+    }
+  };
+  apply(s, fn{*this});
+}
+
+
+// Compile the definition of f into bc. Returns false if f is not
+// supported.
+bool
+compile_function(Context& cxt, Function_decl const& f, Bytecode& bc)
+{
+  if (!f.is_definition() || is<Reference_type>(&f.return_type()))
+    return false;
+  Function_def const* def = as<Function_def>(&f.definition());
+  if (!def)
+    return false;
+
+  bc.fn = &f;
+  bc.nparms = int(f.parameters().size());
+  Compiler comp(cxt, bc);
+  int n = 0;
+  for (Decl const& p : f.parameters()) {
+    if (!is<Object_parm>(&p) || is<Reference_type>(&declared_type(p)))
+      return false;
+    comp.parms.emplace(&p, n++);
+  }
+  try {
+    comp.statement(def->statement());
+  } catch (Unsupported&) {
+    return false;
+  }
+  comp.emit(fail_instr);
+  return true;
+}
+
+
+} // namespace
+
+
+// Returns the compiled definition of f, compiling it if needed, or
+// nullptr if f cannot be compiled. The result is cached for each
+// function.
+Bytecode*
+get_bytecode(Context& cxt, Function_decl const& f)
+{
+  if (Bytecode** prev = cxt.bytecode.find(&f))
+    return *prev;
+
+  // If f is a template specialization, its definition may not have
+  // been instantiated yet.
+  if (!f.is_definition())
+    instantiate_definition(cxt, modify(f));
+
+  Bytecode* result = nullptr;
+  Bytecode bc;
+  if (compile_function(cxt, f, bc))
+    result = &cxt.arena.make<Bytecode>(std::move(bc));
+  cxt.bytecode.insert(&f, result);
+  return result;
+}
+
+
+// Compile an expression to code that computes and returns its value.
+// Returns false if the expression is not supported.
+bool
+compile_expression(Context& cxt, Expr const& e, Bytecode& bc)
+{
+  Compiler comp(cxt, bc);
+  try {
+    int r = comp.reserve();
+    comp.expression(e, r);
+    comp.emit(return_instr, r);
+  } catch (Unsupported&) {
+    return false;
+  }
+  return true;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Execution
+
+// Call the compiled function with the given arguments, of which
+// there are bc.nparms.
+Value
+Machine::call(Bytecode& bc, Value const* args)
+{
+  if (regs.size() < std::size_t(bc.nregs))
+    regs.resize(bc.nregs);
+  std::copy(args, args + bc.nparms, regs.begin());
+  return run(bc, 0);
+}
+
+
+// Execute the code of bc with registers starting at base. The
+// registers of a callee are allocated after those of the caller.
+Value
+Machine::run(Bytecode& bc, std::size_t base)
+{
+  Instruction const* code = bc.code.data();
+  Value* r = &regs[base];
+  int pc = 0;
+  while (true) {
+    Instruction const& i = code[pc++];
+    switch (i.op) {
+      case const_instr:
+        r[i.a] = bc.consts[i.b];
+        break;
+      case move_instr:
+        r[i.a] = r[i.b];
+        break;
+      case add_instr:
+        r[i.a] = add_integers(r[i.b].get_integer(), r[i.c].get_integer());
+        break;
+      case sub_instr:
+        r[i.a] = sub_integers(r[i.b].get_integer(), r[i.c].get_integer());
+        break;
+      case mul_instr:
+        r[i.a] = mul_integers(r[i.b].get_integer(), r[i.c].get_integer());
+        break;
+      case div_instr:
+        r[i.a] = div_integers(r[i.b].get_integer(), r[i.c].get_integer());
+        break;
+      case rem_instr:
+        r[i.a] = rem_integers(r[i.b].get_integer(), r[i.c].get_integer());
+        break;
+      case neg_instr:
+        r[i.a] = neg_integer(r[i.b].get_integer());
+        break;
+      case eq_instr:
+        r[i.a] = Integer_value(r[i.b].get_integer() == r[i.c].get_integer());
+        break;
+      case ne_instr:
+        r[i.a] = Integer_value(r[i.b].get_integer() != r[i.c].get_integer());
+        break;
+      case lt_instr:
+        r[i.a] = Integer_value(r[i.b].get_integer() < r[i.c].get_integer());
+        break;
+      case gt_instr:
+        r[i.a] = Integer_value(r[i.b].get_integer() > r[i.c].get_integer());
+        break;
+      case le_instr:
+        r[i.a] = Integer_value(r[i.b].get_integer() <= r[i.c].get_integer());
+        break;
+      case ge_instr:
+        r[i.a] = Integer_value(r[i.b].get_integer() >= r[i.c].get_integer());
+        break;
+      case not_instr:
+        r[i.a] = !r[i.b].get_integer();
+        break;
+      case bool_instr:
+        r[i.a] = r[i.b].get_integer() != 0;
+        break;
+      case jump_instr:
+        pc = i.a;
+        break;
+      case jump_if_instr:
+        if (r[i.a].get_integer())
+          pc = i.b;
+        break;
+      case jump_unless_instr:
+        if (!r[i.a].get_integer())
+          pc = i.b;
+        break;
+      case call_instr: {
+        Call_site& site = bc.calls[i.b];
+        if (!site.code)
+          site.code = get_bytecode(cxt, *site.fn);
+        std::size_t args = base + i.c;
+        Value v;
+        if (site.code) {
+          // Copy the arguments into the callee's parameters.
+          Bytecode& callee = *site.code;
+          std::size_t next = base + bc.nregs;
+          if (regs.size() < next + callee.nregs)
+            regs.resize(next + callee.nregs);
+          std::copy_n(regs.begin() + args, site.nargs, regs.begin() + next);
+          v = run(callee, next);
+        } else {
+          // Fall back to the evaluator.
+          Evaluator eval(cxt);
+          auto first = regs.begin() + args;
+          v = eval.call(*site.fn, Value_list(first, first + site.nargs));
+        }
+        // The registers may have been reallocated.
+        r = &regs[base];
+        r[i.a] = v;
+        break;
+      }
+      case return_instr:
+        return r[i.a];
+      case fail_instr:
+        throw Evaluation_error("function evaluation failed");
+    }
+  }
+}
+
+
+// Evaluate the given expression using compiled code, falling back
+// to the evaluator if the expression cannot be compiled.
+Value
+execute(Context& cxt, Expr const& e)
+{
+  Bytecode bc;
+  if (!compile_expression(cxt, e, bc))
+    return evaluate(cxt, e);
+  Machine vm(cxt);
+  return vm.call(bc, nullptr);
+}
+
+
+} // namespace banjo
@@ -0,0 +1,123 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_BYTECODE_HPP
+#define BANJO_BYTECODE_HPP
+
+#include "prelude.hpp"
+#include "language.hpp"
+#include "value.hpp"
+
+#include <vector>
+
+
+namespace banjo
+{
+
+// -------------------------------------------------------------------------- //
+// Bytecode
+//
+// Function definitions and expressions can be compiled to code for
+// a register machine. Each function has its own registers; the first
+// registers hold the parameters, and the rest hold temporaries.
+// Compiled code produces the same values as the Evaluator, which is
+// used as a fallback for anything the compiler does not support.
+
+
+// The instructions of the register machine. Unless noted, operands
+// are register numbers.
+enum Opcode : unsigned char
+{
+  const_instr,       // r[a] = consts[b]
+  move_instr,        // r[a] = r[b]
+  add_instr,         // r[a] = r[b] + r[c]
+  sub_instr,         // r[a] = r[b] - r[c]
+  mul_instr,         // r[a] = r[b] * r[c]
+  div_instr,         // r[a] = r[b] / r[c]
+  rem_instr,         // r[a] = r[b] % r[c]
+  neg_instr,         // r[a] = -r[b]
+  eq_instr,          // r[a] = r[b] == r[c]
+  ne_instr,          // r[a] = r[b] != r[c]
+  lt_instr,          // r[a] = r[b] < r[c]
+  gt_instr,          // r[a] = r[b] > r[c]
+  le_instr,          // r[a] = r[b] <= r[c]
+  ge_instr,          // r[a] = r[b] >= r[c]
+  not_instr,         // r[a] = !r[b]
+  bool_instr,        // r[a] = r[b] != 0
+  jump_instr,        // goto a
+  jump_if_instr,     // if (r[a]) goto b
+  jump_unless_instr, // if (!r[a]) goto b
+  call_instr,        // r[a] = call calls[b] with arguments r[c]...
+  return_instr,      // return r[a]
+  fail_instr,        // the end of a function was reached
+};
+
+
+struct Instruction
+{
+  Opcode op;
+  int    a;
+  int    b;
+  int    c;
+};
+
+
+struct Bytecode;
+
+
+// A call to a named function. The compiled code of the callee is
+// resolved on first call.
+struct Call_site
+{
+  Function_decl const* fn;
+  int                  nargs;
+  Bytecode*            code;
+};
+
+
+// The compiled form of a function definition or expression.
+struct Bytecode
+{
+  Bytecode()
+    : fn(nullptr), nparms(0), nregs(0)
+  { }
+
+  Function_decl const*     fn;     // Null for expressions
+  int                      nparms; // Registers holding parameters
+  int                      nregs;  // All registers
+  std::vector<Instruction> code;
+  std::vector<Value>       consts;
+  std::vector<Call_site>   calls;
+};
+
+
+Bytecode* get_bytecode(Context&, Function_decl const&);
+bool      compile_expression(Context&, Expr const&, Bytecode&);
+
+
+// -------------------------------------------------------------------------- //
+// Register machine
+
+// Executes bytecode. Registers for all active calls are kept in
+// a single contiguous stack.
+struct Machine
+{
+  Machine(Context& c)
+    : cxt(c)
+  { }
+
+  Value call(Bytecode&, Value const*);
+  Value run(Bytecode&, std::size_t);
+
+  Context&           cxt;
+  std::vector<Value> regs;
+};
+
+
+Value execute(Context&, Expr const&);
+
+
+} // namespace banjo
+
+
+#endif
@@ -0,0 +1,72 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_CALL_CACHE_HPP
+#define BANJO_CALL_CACHE_HPP
+
+#include "prelude.hpp"
+#include "language.hpp"
+#include "memo.hpp"
+#include "value.hpp"
+
+#include <vector>
+
+
+namespace banjo
+{
+
+// Memoized results of calls to pure functions, keyed on the function
+// and the values of its arguments. Only calls whose arguments are all
+// integers are memoized. See Evaluator::call.
+//
+// Memoization is disabled by default; it is enabled by giving the
+// cache a positive limit. The table holds at most limit results.
+// When it is full, all results are discarded before a new one is
+// recorded.
+struct Call_cache
+{
+  using Key = std::pair<Function_decl const*, std::vector<Integer_value>>;
+
+  Call_cache()
+    : limit(0), nflushes(0)
+  { }
+
+  // Returns true if calls are memoized.
+  bool enabled() const { return limit > 0; }
+
+  // Returns the memoized result of the call k, or nullptr if there
+  // is no such result.
+  Value* find(Key const& k) { return results.find(k); }
+
+  // Record the result v of the call k.
+  void insert(Key const& k, Value const& v)
+  {
+    if (results.size() >= limit) {
+      results.clear();
+      ++nflushes;
+    }
+    results.insert(k, v);
+  }
+
+  // Statistics
+  std::size_t size() const    { return results.size(); }
+  std::size_t hits() const    { return results.hits(); }
+  std::size_t misses() const  { return results.misses(); }
+  std::size_t flushes() const { return nflushes; }
+
+  // The maximum number of memoized results.
+  std::size_t limit;
+
+  Memo_table<Key, Value> results;
+
+  // Memoized results of purity analysis. See is_pure.
+  Memo_table<Function_decl const*, bool> purity;
+
+  std::size_t nflushes;
+};
+
+
+} // namespace banjo
+
+
+#endif
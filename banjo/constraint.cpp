@@ -42,10 +42,8 @@ expand_def(Context& cxt, Concept_def& def, Substitution& sub)
 
 // Expand the concept by substituting the template arguments
 // throughthe concept's definition and normalizing the result.
-//
-// TODO: Memoize the expansions.
 Cons&
-expand(Context& cxt, Concept_cons& c)
+expand_concept(Context& cxt, Concept_cons& c)
 {
   Concept_decl& d = c.declaration();
   Decl_list& tparms = d.parameters();
@@ -65,6 +63,20 @@ expand(Context& cxt, Concept_cons& c)
 }
 
 
+// Returns the expansion of the concept constraint c. Concept
+// constraints are unique, so each is expanded at most once; the
+// result is memoized in the context.
+Cons&
+expand(Context& cxt, Concept_cons& c)
+{
+  if (Cons** p = cxt.expansions.find(&c))
+    return **p;
+  Cons& r = expand_concept(cxt, c);
+  cxt.expansions.insert(&c, &r);
+  return r;
+}
+
+
 Cons const&
 expand(Context& cxt, Concept_cons const& c)
 {
@@ -78,7 +90,7 @@ expand(Context& cxt, Concept_cons const& c)
 // Determine the admissibility of an expression within a dependent
 // context. Note that this is the slow way of doing it since we
 // are doing a full recursion over the constraint in order to find
-// a proof of admissibility.
+// a proof of admissibility. See Admission_index for the fast way.
 
 
 inline Expr*
@@ -127,6 +139,7 @@ admit_binary_expr(Context& cxt, Usage& c, Binary_expr& e)
   // FIXME: See the notes on admit_binary_conv. We may want
   // to preserve the conversions for the purpose of ordering.
   e.ty = &a.type();
+  set_dependence(e);
   return &e;
 }
 
@@ -160,6 +173,7 @@ admit_call_expr(Context& cxt, Usage& c, Call_expr& e)
 
   // Adjust the type and admit the expression.
   e.ty = &a.type();
+  set_dependence(e);
   return &e;
 }
 
@@ -182,7 +196,7 @@ admit_usage_expr(Context& cxt, Usage& c, Expr& e)
   };
 
   // An expression of a different kind prove admissibility.
-  if (typeid(c.expression()) != typeid(e))
+  if (kind_of(c.expression()) != kind_of(e))
     return nullptr;
 
   return apply(e, fn{cxt, c});
@@ -323,9 +337,7 @@ admit_binary_conv(Context& cxt, Conversion_cons& c, Binary_expr& e)
   // prefer #1. Perhaps we should collect viable conversion
   // and then sort at the end. Note that this is true for simple
   // typings also.
-  //
-  // FIXME: Add constructors to the builder. This is just plain dumb.
-  return new Dependent_conv(c.type(), e);
+  return &cxt.make<Dependent_conv>(c.type(), e);
 }
 
 
@@ -342,7 +354,7 @@ admit_usage_conv(Context& cxt, Conversion_cons& c, Expr& e, Type& t)
 
   // An expression of a different kind prove admissibility.
   Expr& e2 = c.expression();
-  if (typeid(e2) != typeid(e))
+  if (kind_of(e2) != kind_of(e))
     return nullptr;
 
   // If the expression's type is not equivalent to t, this constraint
@@ -414,4 +426,138 @@ admit_conversion(Context& cxt, Expr& c, Expr& e, Type& t)
 }
 
 
+// -------------------------------------------------------------------------- //
+// Admission index
+
+auto
+Admission_index::expressions(Term_kind k) const -> Entry_list const*
+{
+  auto iter = exprs.find(k);
+  return iter != exprs.end() ? &iter->second : nullptr;
+}
+
+
+auto
+Admission_index::conversions(Term_kind k) const -> Entry_list const*
+{
+  auto iter = convs.find(k);
+  return iter != convs.end() ? &iter->second : nullptr;
+}
+
+
+namespace
+{
+
+// Add the assumptions of c to the index, in the order in which they
+// would be visited by admit_expression.
+void
+index_constraint(Context& cxt, Admission_index& ix, Cons& c)
+{
+  struct fn
+  {
+    Context&         cxt;
+    Admission_index& ix;
+    void operator()(Cons& c)               { banjo_unhandled_case(c); }
+    void operator()(Predicate_cons& c)     { }
+    void operator()(Concept_cons& c)       { index_constraint(cxt, ix, expand(cxt, c)); }
+    void operator()(Parameterized_cons& c) { index_constraint(cxt, ix, c.constraint()); }
+    void operator()(Disjunction_cons& c)   { ix.rest.push_back({ix.size++, &c}); }
+
+    void operator()(Expression_cons& c)
+    {
+      ix.exprs[kind_of(c.expression())].push_back({ix.size++, &c});
+    }
+
+    void operator()(Conversion_cons& c)
+    {
+      Admission_index::Entry ent {ix.size++, &c};
+      ix.exprs[kind_of(c.expression())].push_back(ent);
+      ix.convs[kind_of(c.expression())].push_back(ent);
+    }
+
+    void operator()(Conjunction_cons& c)
+    {
+      index_constraint(cxt, ix, c.left());
+      index_constraint(cxt, ix, c.right());
+    }
+  };
+  apply(c, fn{cxt, ix});
+}
+
+
+// Returns the first admitted term from the candidates in bucket or
+// rest, visited in their original order.
+template<typename F>
+Expr*
+admit_indexed(Admission_index::Entry_list const* bucket,
+              Admission_index::Entry_list const& rest,
+              F admit)
+{
+  static Admission_index::Entry_list const none;
+  if (!bucket)
+    bucket = &none;
+  auto i = bucket->begin();
+  auto j = rest.begin();
+  while (i != bucket->end() || j != rest.end()) {
+    Admission_index::Entry const* ent;
+    if (j == rest.end() || (i != bucket->end() && i->pos < j->pos))
+      ent = &*i++;
+    else
+      ent = &*j++;
+    if (Expr* r = admit(*ent->cons))
+      return r;
+  }
+  return nullptr;
+}
+
+
+} // namespace
+
+
+// Returns the admission index for the constraint c. Indexes are
+// built once for each (canonical) constraint and are allocated in
+// the context's arena.
+Admission_index&
+make_admission_index(Context& cxt, Cons& c)
+{
+  if (Admission_index** p = cxt.admissions.find(&c))
+    return **p;
+  Admission_index& ix = cxt.arena.make<Admission_index>();
+  index_constraint(cxt, ix, c);
+  cxt.admissions.insert(&c, &ix);
+  return ix;
+}
+
+
+Admission_index&
+make_admission_index(Context& cxt, Expr& c)
+{
+  return make_admission_index(cxt, normalize(cxt, c));
+}
+
+
+// Determine if the expression `e` is admissible under the indexed
+// constraint. This is equivalent to admit_expression on the original
+// constraint, but only usage constraints requiring an expression of
+// the same kind as e are considered.
+Expr*
+admit_expression(Context& cxt, Admission_index& ix, Expr& e)
+{
+  return admit_indexed(ix.expressions(kind_of(e)), ix.rest, [&](Cons& c) {
+    return admit_expression(cxt, c, e);
+  });
+}
+
+
+// Determine if the conversion of `e` to `t` is admissible under the
+// indexed constraint.
+Expr*
+admit_conversion(Context& cxt, Admission_index& ix, Expr& e, Type& t)
+{
+  return admit_indexed(ix.conversions(kind_of(e)), ix.rest, [&](Cons& c) {
+    return admit_conversion(cxt, c, e, t);
+  });
+}
+
+
 } // namespace banjo
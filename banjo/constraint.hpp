@@ -8,6 +8,9 @@
 #include "language.hpp"
 #include "scope.hpp"
 
+#include <unordered_map>
+#include <vector>
+
 
 namespace banjo
 {
@@ -21,6 +24,52 @@ Expr* admit_expression(Context&, Cons&, Expr&);
 Expr* admit_conversion(Context&, Expr&, Expr&, Type&);
 Expr* admit_conversion(Context&, Cons&, Expr&, Type&);
 
+
+// An index of the assumptions in a constraint, used to determine the
+// admissibility of expressions and conversions without recursing
+// through the entire constraint.
+//
+// Conjunctions, parameterized constraints, and concepts are flattened
+// when the index is built. Each usage constraint is filed under the
+// kind of its required expression, so finding candidates for an
+// expression is a single lookup. Constraints that cannot be flattened
+// (disjunctions) are kept in a separate list and searched recursively.
+// Each entry records its position in the original constraint so that
+// candidates are tried in the same order as the full recursion.
+//
+// Note that the types of operands are not part of the key; operands
+// are admitted by implicit conversion to the declared types of the
+// required expression, not by equivalence.
+struct Admission_index
+{
+  struct Entry
+  {
+    std::size_t pos;
+    Cons*       cons;
+  };
+
+  using Entry_list = std::vector<Entry>;
+  using Entry_map = std::unordered_map<int, Entry_list>;
+
+  Admission_index()
+    : size(0)
+  { }
+
+  Entry_list const* expressions(Term_kind) const;
+  Entry_list const* conversions(Term_kind) const;
+
+  Entry_map  exprs; // Expression and conversion constraints
+  Entry_map  convs; // Conversion constraints only
+  Entry_list rest;  // Disjunctions
+  std::size_t size; // The number of entries
+};
+
+Admission_index& make_admission_index(Context&, Cons&);
+Admission_index& make_admission_index(Context&, Expr&);
+
+Expr* admit_expression(Context&, Admission_index&, Expr&);
+Expr* admit_conversion(Context&, Admission_index&, Expr&, Type&);
+
 } // namespace banjo
 
 
@@ -5,6 +5,7 @@
 #include "ast.hpp"
 #include "builder.hpp"
 #include "scope.hpp"
+#include "constraint.hpp"
 #include "token.hpp"
 
 #include <lingo/io.hpp>
@@ -14,8 +15,9 @@ namespace banjo
 {
 
 Context::Context()
-  : Builder(*this), syms(), id(0), tparms {-1, -1}, pholds {-1, -1}
-  , diags(false)
+  : Builder(*this), arena(), syms(), gid(nullptr), global(nullptr), id(0)
+  , tparms {-1, -1}, pholds {-1, -1}, diags(false), prover(sequent_engine)
+  , bools {nullptr, nullptr}
 {
   // Initialize the color system. This is a process-level
   // configuration. Perhaps we we should only initialize
@@ -110,11 +112,13 @@ Context::make_concept_scope(Decl& d)
 }
 
 
-// Create a new constrained scope.
+// Create a new constrained scope. The assumptions of e are indexed
+// when the scope is created.
 Constrained_scope&
 Context::make_constrained_scope(Expr& e)
 {
-  return *new Constrained_scope(current_scope(), e);
+  Admission_index& ix = make_admission_index(*this, e);
+  return *new Constrained_scope(current_scope(), e, ix);
 }
 
 
@@ -180,6 +184,34 @@ Context::current_requires_scope()
   return nullptr;
 }
 
+
+// Returns the innermost constrained scope or nullptr if not
+// currently in the scope of a constrained template.
+Constrained_scope*
+Context::current_constrained_scope()
+{
+  Scope* p = scope;
+  while (p) {
+    if (Constrained_scope* t = as<Constrained_scope>(p))
+      return t;
+    p = p->enclosing_scope();
+  }
+  return nullptr;
+}
+
+
+// Returns the index of assumptions for the current template
+// constraints. This is the index of the innermost constrained scope,
+// if any. Otherwise, the index is found (or built) from the
+// constraints of the current template scope.
+Admission_index&
+Context::current_admissions()
+{
+  if (Constrained_scope* s = current_constrained_scope())
+    return s->admissions();
+  return make_admission_index(*this, *current_template_constraints());
+}
+
 // Find the innermost declaration context. This is the first
 // scope associatd with a declaration. Note that we are guaranteed
 // to have a current context since the outermost scope is the
@@ -5,19 +5,30 @@
 #define BANJO_CONTEXT_HPP
 
 #include "prelude.hpp"
+#include "arena.hpp"
+#include "factory.hpp"
+#include "memo.hpp"
 #include "scope.hpp"
 #include "builder.hpp"
+#include "subsumption.hpp"
+#include "evaluation_mode.hpp"
+#include "instantiation.hpp"
+#include "substitution.hpp"
+#include "call_cache.hpp"
+#include "jit.hpp"
 
 
 namespace banjo
 {
 
 struct Scope;
+struct Bytecode;
 
 
 // A repository of information to support translation.
 //
-// TODO: Add an allocator/object pool and management support.
+// The context owns the arena in which all terms are allocated. Those
+// terms are released when the context is destroyed.
 //
 // TODO: Integrate diagnostics.
 struct Context : Builder
@@ -61,6 +72,11 @@ struct Context : Builder
   Decl_list*      current_template_parameters();
   Expr*           current_template_constraints();
   Requires_scope* current_requires_scope();
+  Constrained_scope* current_constrained_scope();
+
+  // Returns the index of assumptions in the current template
+  // constraints.
+  Admission_index& current_admissions();
 
   // Declaration context queries
   Decl&           current_context();
@@ -88,8 +104,13 @@ struct Context : Builder
   // Diagnostic state
   bool diagnose_errors() const { return diags; }
 
+  // Memory for terms. This must be declared before any member that
+  // refers to terms, so that it is destroyed last.
+  Arena           arena;
+
   Symbol_table    syms;
   Location        input;  // The input location
+  Global_id*      gid;    // The global identifier
   Namespace_decl* global; // The global namespace
   Scope*          scope;  // The current scope
 
@@ -103,9 +124,94 @@ struct Context : Builder
 
   // Diagnostic state
   bool diags; // True if diagnostics should be emitted.
+
+  // The algorithm used to decide subsumption.
+  Subsumption_engine prover;
+
+  // The algorithm used to evaluate constant expressions.
+  Evaluation_mode evaluation;
+
+  // Canonical names.
+  Unique_factory<Name> ids;
+
+  // Canonical types.
+  Type_factory types;
+
+  // Shared literals. See Builder::get_bool and Builder::get_integer.
+  Boolean_expr* bools[2];
+  std::unordered_map<Type const*, std::vector<Integer_expr*>> ints;
+
+  // Canonical constraints.
+  Unique_factory<Concept_cons>       concept_cons;
+  Unique_factory<Predicate_cons>     predicate_cons;
+  Unique_factory<Expression_cons>    expression_cons;
+  Unique_factory<Conversion_cons>    conversion_cons;
+  Unique_factory<Parameterized_cons> parameterized_cons;
+  Unique_factory<Conjunction_cons>   conjunction_cons;
+  Unique_factory<Disjunction_cons>   disjunction_cons;
+
+  // Canonical constraints, indexed by their unique id.
+  std::vector<Cons*> constraints;
+
+  // Memoized normal forms of constraint expressions. See
+  // normalization.cpp.
+  Memo_table<Expr const*, Cons*> normalizations;
+
+  // Memoized expansions of concept constraints. See constraint.cpp.
+  Memo_table<Concept_cons const*, Cons*> expansions;
+
+  // Memoized results of constraint satisfaction. See satisfaction.cpp.
+  Memo_table<Cons const*, bool> satisfactions;
+
+  // Memoized results of subsumption, keyed on the antecedent and
+  // consequent. See subsumption.cpp.
+  Memo_table<std::pair<Cons const*, Cons const*>, bool> subsumptions;
+
+  // Memoized results of partial ordering by specialization, keyed
+  // on the pair of templates. See template.cpp.
+  Memo_table<std::pair<Template_decl const*, Template_decl const*>, bool> orderings;
+
+  // Indexes of assumptions, keyed on normalized constraints. See
+  // constraint.cpp.
+  Memo_table<Cons const*, Admission_index*> admissions;
+
+  // Memoized results of template argument deduction from a call,
+  // keyed on the function template and the types of the arguments.
+  // Failed deductions are recorded as invalid substitutions. See
+  // deduction.cpp.
+  using Deduction_key = std::pair<Template_decl const*, std::vector<Type const*>>;
+  Memo_table<Deduction_key, Substitution> deductions;
+
+  // Compiled function definitions. Functions that cannot be
+  // compiled are recorded as null. See bytecode.cpp.
+  Memo_table<Function_decl const*, Bytecode*> bytecode;
+
+  // Specializations whose definitions are needed. See
+  // instantiation.cpp.
+  Instantiation_queue instantiations;
+
+  // Memoized results of calls to pure functions during evaluation.
+  // This is disabled by default. See evaluation.cpp.
+  Call_cache calls;
+
+  // Native compilation of frequently evaluated functions. This is
+  // disabled by default. See jit.cpp.
+  Jit_tier jit;
 };
 
 
+// Allocate an object of the given type in the context's arena.
+// The dependence of types and expressions is computed here.
+template<typename T, typename... Args>
+inline T&
+Builder::make(Args&&... args)
+{
+  T& t = set_kind(cxt.arena.make<T>(std::forward<Args>(args)...));
+  set_dependence(t);
+  return t;
+}
+
+
 inline Index
 Context::make_template_parameter_index()
 {
@@ -35,7 +35,7 @@ Expr&
 convert_object_to_value(Expr& e, Type& t)
 {
   if (Reference_type* et = as<Reference_type>(&e.type()))
-    return *new Value_conv(et->type(), e);
+    return set_dependence(*new Value_conv(et->type(), e));
   return e;
 }
 
@@ -59,7 +59,7 @@ Expr&
 convert_to_bool(Expr& e, Boolean_type& t)
 {
   if (is<Integer_type>(&e.type()))
-    return *new Boolean_conv(t, e);
+    return set_dependence(*new Boolean_conv(t, e));
   return e;
 }
 
@@ -85,16 +85,16 @@ convert_to_wider_integer(Expr& e, Integer_type& t)
     // actually going to happen. Especially, if we convert
     // sign and widen simultaneously.
     if (et.precision() < t.precision())
-      return *new Integer_conv(t, e);
+      return set_dependence(*new Integer_conv(t, e));
     else if (et.sign() != t.sign())
-      return *new Integer_conv(t, e);
+      return set_dependence(*new Integer_conv(t, e));
     else
       return e;
   }
 
   // A value of type bool can be converted...
   if (is<Boolean_type>(&e.type()))
-    return *new Integer_conv(t, e);
+    return set_dependence(*new Integer_conv(t, e));
 
   return e;
 }
@@ -247,7 +247,7 @@ is_similar(Type const& a, Type const& b)
   Type const& ua = a.unqualified_type();
   Type const& ub = b.unqualified_type();
 
-  if (typeid(ua) != typeid(ub))
+  if (kind_of(ua) != kind_of(ub))
     return false;
   else
     return apply(ua, fn{ub});
@@ -369,7 +369,7 @@ convert_qualifier(Expr& e, Type& t)
     Qualifier_list sa = get_qualification_signature(e.type());
     Qualifier_list sb = get_qualification_signature(t);
     if (can_convert_signature(sa, sb))
-      return *new Qualification_conv(t, e);
+      return set_dependence(*new Qualification_conv(t, e));
   }
   return e;
 }
@@ -686,14 +686,13 @@ dependent_conversion(Context& cxt, Expr& e, Type& t)
     // constructible.
     Expr& c = standard_conversion(e, t);
     (void)c;
-    return *new Dependent_conv(t, e);
+    return set_dependence(*new Dependent_conv(t, e));
   } catch (Translation_error&) {
     // Fall through...
   }
 
   // Search for a conversion to t among the listed constraints.
-  Expr& cons = *cxt.current_template_constraints();
-  if (Expr* c = admit_conversion(cxt, cons, e, t)) {
+  if (Expr* c = admit_conversion(cxt, cxt.current_admissions(), e, t)) {
     return *c;
   }
 
@@ -4,12 +4,15 @@
 #include "declaration.hpp"
 #include "ast_type.hpp"
 #include "ast_decl.hpp"
+#include "ast_def.hpp"
+#include "ast_stmt.hpp"
 #include "context.hpp"
 #include "scope.hpp"
 #include "lookup.hpp"
 #include "overload.hpp"
 #include "print.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 
@@ -70,7 +73,7 @@ redeclare(Overload_set& ovl, Decl& given)
   // If the declarations have different kinds, then this
   // is clearly not a redeclaraiton.
   Decl& rep = ovl.front();
-  if (typeid(rep) != typeid(given))
+  if (kind_of(rep) != kind_of(given))
     return nullptr;
 
   // Every declaration in ovl has the same kind as given.
@@ -227,4 +230,57 @@ declare_required_expression(Context& cxt, Expr& e)
   s.exprs.push_back(e);
 }
 
+
+// -------------------------------------------------------------------------- //
+// Frame allocation
+
+namespace
+{
+
+// Assign slots to the variables declared in the statement s, starting
+// with the slot n. The slots of a block are reused by later blocks.
+// Returns the number of slots needed by s.
+int
+allocate_slots(Stmt& s, int n)
+{
+  if (Declaration_stmt* d = as<Declaration_stmt>(&s)) {
+    if (Object_decl* var = as<Object_decl>(&d->declaration())) {
+      var->slot = n;
+      return n + 1;
+    }
+  }
+  if (Compound_stmt* b = as<Compound_stmt>(&s)) {
+    int max = n;
+    for (Stmt& s1 : b->statements()) {
+      int top = allocate_slots(s1, n);
+      max = std::max(max, top);
+
+      // Variables declared directly in the block remain in scope.
+      if (is<Declaration_stmt>(&s1))
+        n = top;
+    }
+    return max;
+  }
+  return n;
+}
+
+} // namespace
+
+
+// Assign each parameter and local variable of the function f a slot
+// in its frame. The evaluator stores the objects of a call at those
+// slots. This must be done after f is defined.
+void
+allocate_frame(Function_decl& f)
+{
+  int n = 0;
+  for (Decl& p : f.parameters())
+    if (Object_decl* parm = as<Object_decl>(&p))
+      parm->slot = n++;
+  if (f.is_definition())
+    if (Function_def* def = as<Function_def>(&f.definition()))
+      n = allocate_slots(def->statement(), n);
+  f.frame = n;
+}
+
 } // namespace banjo
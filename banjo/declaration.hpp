@@ -21,6 +21,8 @@ void declare(Context&, Scope&, Decl&);
 
 void declare_required_expression(Context&, Expr&);
 
+void allocate_frame(Function_decl&);
+
 } // namespace banjo
 
 
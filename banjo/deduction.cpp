@@ -242,4 +242,41 @@ deduce_from_call(Context& cxt, Decl_list& parms, Expr_list& args, Substitution&
 }
 
 
+// Deduce the template arguments of the function template `tmp` from
+// the arguments of a call. The substitution shall initially map each
+// template parameter to nothing.
+//
+// Deduction depends only on the types of the arguments, so results
+// are memoized for each template and list of argument types. Repeated
+// calls with the same argument types do not repeat the deduction.
+// Failures are also memoized. Note that a memoized failure produces
+// a less specific diagnostic than the original.
+void
+deduce_from_call(Context& cxt, Template_decl& tmp, Expr_list& args, Substitution& sub)
+{
+  Context::Deduction_key key {&tmp, {}};
+  key.second.reserve(args.size());
+  for (Expr& a : args)
+    key.second.push_back(&a.type());
+
+  if (Substitution* prev = cxt.deductions.find(key)) {
+    if (!*prev)
+      throw Deduction_error(cxt, "deduction failed for '{}'", tmp.name());
+    sub = *prev;
+    return;
+  }
+
+  Function_decl& f = cast<Function_decl>(tmp.parameterized_declaration());
+  try {
+    deduce_from_call(cxt, f.parameters(), args, sub);
+  } catch (Deduction_error&) {
+    Substitution fail;
+    fail.fail();
+    cxt.deductions.insert(key, fail);
+    throw;
+  }
+  cxt.deductions.insert(key, sub);
+}
+
+
 } // namespace banjo
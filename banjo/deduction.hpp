@@ -22,6 +22,7 @@ bool deduce_from_type(Type&, Type&, Substitution&);
 bool deduce_from_types(Type_list&, Type_list&, Substitution&);
 
 void deduce_from_call(Context&, Decl_list&, Expr_list&, Substitution&);
+void deduce_from_call(Context&, Template_decl&, Expr_list&, Substitution&);
 
 void deduce_from_address(Type&, Type&, Substitution&);
 void deduce_from_conversion(Type&, Type&, Substitution&);
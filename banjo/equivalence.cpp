@@ -4,8 +4,6 @@
 #include "equivalence.hpp"
 #include "ast.hpp"
 
-#include <typeindex>
-
 
 namespace banjo
 {
@@ -22,17 +20,15 @@ is_equivalent(Term const& x1, Term const& x2)
     return true;
 
   // Types of different kinds are not the same.
-  std::type_index ti1 = typeid(x1);
-  std::type_index ti2 = typeid(x2);
-  if (ti1 != ti2)
+  if (kind_of(x1) != kind_of(x2))
     return false;
 
-  if (Type const* t1 = as<Type>(&x1))
-    return is_equivalent(*t1, cast<Type>(x2));
-  if (Expr const* t1 = as<Expr>(&x1))
-    return is_equivalent(*t1, cast<Expr>(x2));
-  if (Decl const* t1 = as<Decl>(&x1))
-    return is_equivalent(*t1, cast<Decl>(x2));
+  if (Type const* t1 = dyn_cast<Type>(&x1))
+    return is_equivalent(*t1, static_cast<Type const&>(x2));
+  if (Expr const* t1 = dyn_cast<Expr>(&x1))
+    return is_equivalent(*t1, static_cast<Expr const&>(x2));
+  if (Decl const* t1 = dyn_cast<Decl>(&x1))
+    return is_equivalent(*t1, static_cast<Decl const&>(x2));
   banjo_unhandled_case(x1);
 }
 
@@ -136,9 +132,7 @@ is_equivalent(Name const& n1, Name const& n2)
     return true;
 
   // Types of different kinds are not the same.
-  std::type_index ti1 = typeid(n1);
-  std::type_index ti2 = typeid(n2);
-  if (ti1 != ti2)
+  if (kind_of(n1) != kind_of(n2))
     return false;
 
   // Find a comparison of the types.
@@ -288,10 +282,14 @@ is_equivalent(Type const& t1, Type const& t2)
   if (&t1 == &t2)
     return true;
 
+  // Canonical types are unique, so distinct canonical types are
+  // never the same. Only types built outside of the builder need
+  // to be compared structurally.
+  if (t1.is_canonical() && t2.is_canonical())
+    return false;
+
   // Types of different kinds are not the same.
-  std::type_index ti1 = typeid(t1);
-  std::type_index ti2 = typeid(t2);
-  if (ti1 != ti2)
+  if (kind_of(t1) != kind_of(t2))
     return false;
 
   // Find a comparison of the types.
@@ -360,9 +358,7 @@ is_equivalent(Expr const& e1, Expr const& e2)
     return true;
 
   // Types of different kinds are not the same.
-  std::type_index ti1 = typeid(e1);
-  std::type_index ti2 = typeid(e2);
-  if (ti1 != ti2)
+  if (kind_of(e1) != kind_of(e2))
     return false;
 
   // Delegate to specific rules.
@@ -474,9 +470,7 @@ is_equivalent(Cons const& c1, Cons const& c2)
     return true;
 
   // Types of different kinds are not the same.
-  std::type_index ti1 = typeid(c1);
-  std::type_index ti2 = typeid(c2);
-  if (ti1 != ti2)
+  if (kind_of(c1) != kind_of(c2))
     return false;
 
   // Delegate to specific rules.
@@ -4,26 +4,72 @@
 #include "evaluation.hpp"
 #include "ast.hpp"
 #include "builder.hpp"
+#include "bytecode.hpp"
+#include "declaration.hpp"
+#include "instantiation.hpp"
+#include "jit.hpp"
 #include "print.hpp"
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
 
 
 namespace banjo
 {
 
+// -------------------------------------------------------------------------- //
+// Call stack
+
+constexpr std::size_t Call_stack::block_size;
+
+
+// Allocate a frame of n values. If the current block cannot hold
+// the frame, the frame is allocated in the next block that can.
+Value*
+Call_stack::allocate(std::size_t n)
+{
+  while (block < blocks.size() && used + n > blocks[block].size()) {
+    ++block;
+    used = 0;
+  }
+  if (block == blocks.size()) {
+    blocks.emplace_back(std::max(n, block_size));
+    used = 0;
+  }
+  Value* p = blocks[block].data() + used;
+  std::fill(p, p + n, Value());
+  used += n;
+  return p;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Memory management
+
+// Returns the storage of the object declared by `d` in the current
+// frame.
+//
+// FIXME: Global variables do not have storage.
+Value&
+Evaluator::local(Decl const& d)
+{
+  Object_decl const* var = as<Object_decl>(&d);
+  if (!var || var->slot < 0 || !frame)
+    throw Evaluation_error("object has no storage");
+  return frame[var->slot];
+}
+
+
 // Returns a reference to the object or function corresponding
 // do the declaration `d`.
-//
-// FIXME: If d refers to a global variable, then we may not
-// have a binding for for it. We most definitely should.
 Value
 Evaluator::alias(Decl const& d)
 {
   // If the expression refers to an object, then produce
   // a reference to its stored value.
-  if (Object_decl const* var = as<Object_decl>(&d))
-    return &stack.lookup(var)->second;
+  if (is<Object_decl>(&d))
+    return &local(d);
 
   // If the expression refers to a function, then produce
   // a reference to that function.
@@ -42,8 +88,8 @@ Evaluator::load(Decl const& d)
 {
   // If the expression refers to an object, then produce
   // a reference to its stored value.
-  if (Object_decl const* var = as<Object_decl>(&d))
-    return stack.lookup(var)->second;
+  if (is<Object_decl>(&d))
+    return local(d);
 
   // What else?
   banjo_unhandled_case(d);
@@ -53,13 +99,10 @@ Evaluator::load(Decl const& d)
 // Stores a value in the object corresponding to the given
 // declaration. This copies the value into the object, and
 // returns a reference to that value.
-//
-// FIXME: We should not be able to store values in objects that
-// have not been allocated.
 Value&
 Evaluator::store(Decl const& d, Value const& v)
 {
-  return stack.top().rebind(&d, v).second;
+  return local(d) = v;
 }
 
 
@@ -104,11 +147,40 @@ Evaluator::evaluate(Expr const& e)
     Value operator()(And_expr const& e) { return self.evaluate_and(e); }
     Value operator()(Or_expr const& e) { return self.evaluate_or(e); }
     Value operator()(Not_expr const& e) { return self.evaluate_not(e); }
+    Value operator()(Neg_expr const& e) { return self.evaluate_neg(e); }
+    Value operator()(Pos_expr const& e) { return self.evaluate_value(e.operand()); }
+    Value operator()(Conv const& e) { return self.evaluate_conversion(e); }
+    Value operator()(Copy_init const& e) { return self.evaluate_value(e.expression()); }
+
+    Value operator()(Add_expr const& e) { return self.evaluate_binary(e, add_integers); }
+    Value operator()(Sub_expr const& e) { return self.evaluate_binary(e, sub_integers); }
+    Value operator()(Mul_expr const& e) { return self.evaluate_binary(e, mul_integers); }
+    Value operator()(Div_expr const& e) { return self.evaluate_binary(e, div_integers); }
+    Value operator()(Rem_expr const& e) { return self.evaluate_binary(e, rem_integers); }
+
+    Value operator()(Eq_expr const& e) { return self.evaluate_binary(e, std::equal_to<Integer_value>()); }
+    Value operator()(Ne_expr const& e) { return self.evaluate_binary(e, std::not_equal_to<Integer_value>()); }
+    Value operator()(Lt_expr const& e) { return self.evaluate_binary(e, std::less<Integer_value>()); }
+    Value operator()(Gt_expr const& e) { return self.evaluate_binary(e, std::greater<Integer_value>()); }
+    Value operator()(Le_expr const& e) { return self.evaluate_binary(e, std::less_equal<Integer_value>()); }
+    Value operator()(Ge_expr const& e) { return self.evaluate_binary(e, std::greater_equal<Integer_value>()); }
   };
   return apply(e, fn{*this});
 }
 
 
+// Evaluate the given expression, producing the value of the
+// referenced object when e refers to an object.
+Value
+Evaluator::evaluate_value(Expr const& e)
+{
+  Value v = evaluate(e);
+  if (v.is_reference())
+    return *v.get_reference();
+  return v;
+}
+
+
 Value
 Evaluator::evaluate_boolean(Boolean_expr const& e)
 {
@@ -134,12 +206,115 @@ Evaluator::evaluate_reference(Reference_expr const& e)
 }
 
 
+// Evaluate the callee and arguments of a call, and invoke the
+// function. Arguments are loaded, except when the corresponding
+// parameter is a reference.
 Value
 Evaluator::evaluate_call(Call_expr const& e)
 {
   Value v = evaluate(e.function());
   Function_decl const& f = *v.get_function();
 
+  Value_list args;
+  Expr_list const& exprs = e.arguments();
+  Decl_list const& parms = f.parameters();
+  auto ai = exprs.begin();
+  auto pi = parms.begin();
+  while (ai != exprs.end() && pi != parms.end()) {
+    if (is<Reference_type>(&declared_type(*pi)))
+      args.push_back(evaluate(*ai));
+    else
+      args.push_back(evaluate_value(*ai));
+    ++ai;
+    ++pi;
+  }
+  return call(f, args);
+}
+
+
+// Invoke the function `f` with the given arguments. When enabled,
+// the results of calls to pure functions are memoized in the
+// context.
+Value
+Evaluator::call(Function_decl const& f, Value_list const& args)
+{
+  // If f is a template specialization, its definition may not have
+  // been instantiated yet.
+  if (!f.is_definition() && cxt)
+    instantiate_definition(*cxt, modify(f));
+
+  Call_cache::Key key;
+  if (!memoize(f, args, key))
+    return invoke(f, args);
+  if (Value* v = cxt->calls.find(key))
+    return *v;
+  Value result = invoke(f, args);
+  cxt->calls.insert(key, result);
+  return result;
+}
+
+
+// Evaluate the definition of `f` with the given arguments.
+Value
+Evaluator::invoke(Function_decl const& f, Value_list const& args)
+{
+  // Frequently evaluated functions may have been compiled to native
+  // code, which computes only integers.
+  if (cxt && cxt->jit.enabled()) {
+    if (Native_function fn = get_native_function(*cxt, f)) {
+      auto is_int = [](Value const& v) { return v.is_integer(); };
+      if (args.size() == f.parameters().size()
+          && std::all_of(args.begin(), args.end(), is_int))
+        return call_native(*cxt, fn, args);
+    }
+  }
+
+  Function_def const& def = prepare(f);
+  Enter_frame scope(*this, f.frame);
+  bind(f, args);
+
+  // Evaluate the function definition.
+  //
+  // TODO: Check result in case we've thrown an exception.
+  //
+  // FIXME: Failure to evaluate is a translation error, not
+  // an internal error.
+  Value result;
+  Control ctl = evaluate(def.statement(), result);
+  if (ctl != return_ctl)
+    throw Evaluation_error("function evaluation failed");
+
+  // A reference to a local object does not outlive the call.
+  if (result.is_reference() && !is<Reference_type>(&f.return_type()))
+    return *result.get_reference();
+  return result;
+}
+
+
+// Returns true if the result of calling `f` with the given arguments
+// is memoized, and sets the key for the call. Only calls to pure
+// functions whose arguments are integers are memoized.
+bool
+Evaluator::memoize(Function_decl const& f, Value_list const& args, Call_cache::Key& key)
+{
+  if (!cxt || !cxt->calls.enabled() || !is_pure(*cxt, f))
+    return false;
+  key.first = &f;
+  key.second.clear();
+  key.second.reserve(args.size());
+  for (Value const& v : args) {
+    if (!v.is_integer())
+      return false;
+    key.second.push_back(v.get_integer());
+  }
+  return true;
+}
+
+
+// Returns the definition of `f`, which is about to be called.
+Function_def const&
+Evaluator::prepare(Function_decl const& f)
+{
   // Get the function's definition.
   if (!f.is_definition())
     throw Internal_error("function '{}' is not defined", f.name());
@@ -156,67 +331,95 @@ Evaluator::evaluate_call(Call_expr const& e)
   if (!def)
     lingo_unimplemented();
 
-  // Each parameter is declared as a local variable within the
-  // function.
-  Enter_frame frame(*this);
-  Expr_list const& args = e.arguments();
+  // Slots are assigned when the function is defined, but functions
+  // built elsewhere may not have them yet.
+  if (f.frame < 0)
+    allocate_frame(modify(f));
+  return *def;
+}
+
+
+// Store the arguments in the parameters of `f`, in the current
+// frame.
+void
+Evaluator::bind(Function_decl const& f, Value_list const& args)
+{
   Decl_list const& parms = f.parameters();
   auto ai = args.begin();
   auto pi = parms.begin();
   while (ai != args.end() && pi != parms.end()) {
-    Expr const& arg = *ai;
-    Decl const& parm = *pi;
-
     // TODO: Parameters are copy-initialized. Reuse initialization
     // here, insted of this kind of direct storage. Use alloca
     // and then dispatch to the initializer.
-    store(parm, evaluate(arg));
+    store(*pi, *ai);
+    ++ai;
+    ++pi;
   }
-
-  // Evaluate the function definition.
-  //
-  // TODO: Check result in case we've thrown an exception.
-  //
-  // FIXME: Failure to evaluate is a translation error, not
-  // an internal error.
-  Value result;
-  Control ctl = evaluate(def->statement(), result);
-  if (ctl != return_ctl)
-    throw Evaluation_error("function evaluation failed");
-  return result;
 }
 
 
 Value
 Evaluator::evaluate_and(And_expr const& e)
 {
-  Value v = evaluate(e.left());
+  Value v = evaluate_value(e.left());
   if (!v.get_integer())
     return v;
   else
-    return evaluate(e.right());
+    return evaluate_value(e.right());
 }
 
 
 Value
 Evaluator::evaluate_or(Or_expr const& e)
 {
-  Value v = evaluate(e.left());
+  Value v = evaluate_value(e.left());
   if (v.get_integer())
     return v;
   else
-    return evaluate(e.right());
+    return evaluate_value(e.right());
 }
 
 
 Value
 Evaluator::evaluate_not(Not_expr const& e)
 {
-  Value v = evaluate(e.operand());
+  Value v = evaluate_value(e.operand());
   return !v.get_integer();
 }
 
 
+Value
+Evaluator::evaluate_neg(Neg_expr const& e)
+{
+  Value v = evaluate_value(e.operand());
+  return neg_integer(v.get_integer());
+}
+
+
+// Apply the integer operation `op` to the values of the operands.
+template<typename Op>
+Value
+Evaluator::evaluate_binary(Binary_expr const& e, Op op)
+{
+  Value v1 = evaluate_value(e.left());
+  Value v2 = evaluate_value(e.right());
+  return Integer_value(op(v1.get_integer(), v2.get_integer()));
+}
+
+
+// Conversions between integer and boolean values only change
+// the value for conversions to bool. An object-to-value conversion
+// loads the referenced object.
+Value
+Evaluator::evaluate_conversion(Conv const& e)
+{
+  Value v = evaluate_value(e.source());
+  if (is<Boolean_conv>(&e))
+    return v.get_integer() != 0;
+  return v;
+}
+
+
 // -------------------------------------------------------------------------- //
 // Evaluation of statements
 
@@ -244,7 +447,6 @@ Evaluator::evaluate(Stmt const& s, Value& r)
 Control
 Evaluator::evaluate_block(Compound_stmt const& s, Value& r)
 {
-  Enter_frame frame(*this);
   for (Stmt const& s1 : s.statements()) {
     Control ctl = evaluate(s1, r);
     switch (ctl) {
@@ -300,13 +502,567 @@ Evaluator::elaborate(Decl const& d)
 }
 
 
+// Allocate storage for the object declared by d, and initialize it
+// with the value of its initializer, if any.
 void
 Evaluator::elaborate_object(Object_decl const& d)
 {
-  // FIXME: Implement initialization!
-  Value& v = alloca(d);
-  (void)v;
-  lingo_unimplemented();
+  alloca(d);
+  if (d.init)
+    store(d, evaluate_value(*d.init));
+}
+
+
+// -------------------------------------------------------------------------- //
+// Iterative evaluation
+
+// Evaluate the expression e. Tasks are performed until none remain,
+// leaving the value of e on the value stack.
+Value
+Iterative_evaluator::run(Expr const& e)
+{
+  tasks.clear();
+  values.clear();
+  calls.clear();
+  frame = nullptr;
+  stack.release({0, 0});
+
+  push(eval_task, e);
+  std::size_t steps = 0;
+  while (!tasks.empty()) {
+    if (++steps > step_limit)
+      throw Evaluation_error("evaluation exceeded the step limit");
+    Task t = tasks.back();
+    tasks.pop_back();
+    step(t);
+  }
+  return pop();
+}
+
+
+void
+Iterative_evaluator::step(Task const& t)
+{
+  switch (t.kind) {
+    case eval_task:
+      eval(static_cast<Expr const&>(*t.term));
+      break;
+    case load_task:
+      if (values.back().is_reference())
+        values.back() = *values.back().get_reference();
+      break;
+    case apply_task:
+      apply_operator(static_cast<Expr const&>(*t.term));
+      break;
+    case branch_task:
+      branch(static_cast<Binary_expr const&>(*t.term));
+      break;
+    case args_task:
+      arguments(static_cast<Call_expr const&>(*t.term));
+      break;
+    case call_task:
+      apply_call(t.n);
+      break;
+    case exec_task:
+      exec(static_cast<Stmt const&>(*t.term));
+      break;
+    case init_task:
+      alloca(static_cast<Decl const&>(*t.term));
+      store(static_cast<Decl const&>(*t.term), pop());
+      break;
+    case discard_task:
+      values.pop_back();
+      break;
+    case return_task:
+      leave(pop());
+      break;
+    case leave_task:
+      throw Evaluation_error("function evaluation failed");
+  }
+}
+
+
+// Schedule the evaluation of e. Operands are evaluated before the
+// operator is applied, so their tasks are pushed last.
+void
+Iterative_evaluator::eval(Expr const& e)
+{
+  struct fn
+  {
+    Iterative_evaluator& self;
+
+    void operator()(Expr const& e) { banjo_unhandled_case(e); }
+
+    void operator()(Boolean_expr const& e)   { self.values.push_back(self.evaluate_boolean(e)); }
+    void operator()(Integer_expr const& e)   { self.values.push_back(self.evaluate_integer(e)); }
+    void operator()(Reference_expr const& e) { self.values.push_back(self.evaluate_reference(e)); }
+
+    void operator()(Call_expr const& e)
+    {
+      self.push(args_task, e);
+      self.push(eval_task, e.function());
+    }
+
+    void operator()(And_expr const& e) { branch(e); }
+    void operator()(Or_expr const& e)  { branch(e); }
+
+    void operator()(Not_expr const& e) { unary(e, e.operand()); }
+    void operator()(Neg_expr const& e) { unary(e, e.operand()); }
+    void operator()(Pos_expr const& e) { unary(e, e.operand()); }
+    void operator()(Conv const& e)     { unary(e, e.source()); }
+
+    // Copy initialization produces the value of its operand.
+    void operator()(Copy_init const& e)
+    {
+      self.push(load_task);
+      self.push(eval_task, e.expression());
+    }
+
+    void operator()(Add_expr const& e) { binary(e); }
+    void operator()(Sub_expr const& e) { binary(e); }
+    void operator()(Mul_expr const& e) { binary(e); }
+    void operator()(Div_expr const& e) { binary(e); }
+    void operator()(Rem_expr const& e) { binary(e); }
+    void operator()(Eq_expr const& e)  { binary(e); }
+    void operator()(Ne_expr const& e)  { binary(e); }
+    void operator()(Lt_expr const& e)  { binary(e); }
+    void operator()(Gt_expr const& e)  { binary(e); }
+    void operator()(Le_expr const& e)  { binary(e); }
+    void operator()(Ge_expr const& e)  { binary(e); }
+
+    void unary(Expr const& e, Expr const& arg)
+    {
+      self.push(apply_task, e);
+      self.push(load_task);
+      self.push(eval_task, arg);
+    }
+
+    void binary(Binary_expr const& e)
+    {
+      self.push(apply_task, e);
+      self.push(load_task);
+      self.push(eval_task, e.right());
+      self.push(load_task);
+      self.push(eval_task, e.left());
+    }
+
+    void branch(Binary_expr const& e)
+    {
+      self.push(branch_task, e);
+      self.push(load_task);
+      self.push(eval_task, e.left());
+    }
+  };
+  apply(e, fn{*this});
+}
+
+
+namespace
+{
+
+// Replace the operand on the value stack with op applied to it.
+template<typename Op>
+inline void
+apply_unary(std::vector<Value>& vs, Op op)
+{
+  vs.back() = op(vs.back().get_integer());
+}
+
+
+// Replace the operands on the value stack with op applied to them.
+template<typename Op>
+inline void
+apply_binary(std::vector<Value>& vs, Op op)
+{
+  Value v2 = vs.back();
+  vs.pop_back();
+  vs.back() = Integer_value(op(vs.back().get_integer(), v2.get_integer()));
+}
+
+} // namespace
+
+
+// Apply the operator e to the values of its operands.
+void
+Iterative_evaluator::apply_operator(Expr const& e)
+{
+  struct fn
+  {
+    Iterative_evaluator& self;
+
+    void operator()(Expr const& e)     { banjo_unhandled_case(e); }
+    void operator()(Pos_expr const& e) { }
+    void operator()(Not_expr const& e) { apply_unary(self.values, [](Integer_value n) { return !n; }); }
+    void operator()(Neg_expr const& e) { apply_unary(self.values, neg_integer); }
+
+    void operator()(Conv const& e)
+    {
+      if (is<Boolean_conv>(&e))
+        apply_unary(self.values, [](Integer_value n) { return n != 0; });
+    }
+
+    void operator()(Add_expr const& e) { apply_binary(self.values, add_integers); }
+    void operator()(Sub_expr const& e) { apply_binary(self.values, sub_integers); }
+    void operator()(Mul_expr const& e) { apply_binary(self.values, mul_integers); }
+    void operator()(Div_expr const& e) { apply_binary(self.values, div_integers); }
+    void operator()(Rem_expr const& e) { apply_binary(self.values, rem_integers); }
+    void operator()(Eq_expr const& e)  { apply_binary(self.values, std::equal_to<Integer_value>()); }
+    void operator()(Ne_expr const& e)  { apply_binary(self.values, std::not_equal_to<Integer_value>()); }
+    void operator()(Lt_expr const& e)  { apply_binary(self.values, std::less<Integer_value>()); }
+    void operator()(Gt_expr const& e)  { apply_binary(self.values, std::greater<Integer_value>()); }
+    void operator()(Le_expr const& e)  { apply_binary(self.values, std::less_equal<Integer_value>()); }
+    void operator()(Ge_expr const& e)  { apply_binary(self.values, std::greater_equal<Integer_value>()); }
+
+  };
+  apply(e, fn{*this});
+}
+
+
+// The value of the left operand of && or || is on the stack. If
+// that does not determine the result, replace it with the value of
+// the right operand.
+void
+Iterative_evaluator::branch(Binary_expr const& e)
+{
+  bool v = values.back().get_integer();
+  bool done = is<And_expr>(&e) ? !v : v;
+  if (!done) {
+    values.pop_back();
+    push(load_task);
+    push(eval_task, e.right());
+  }
+}
+
+
+// The callee is on the stack. Schedule the evaluation of the
+// arguments. Arguments are loaded, except when the corresponding
+// parameter is a reference.
+void
+Iterative_evaluator::arguments(Call_expr const& e)
+{
+  Function_decl const& f = *values.back().get_function();
+  Expr_list const& exprs = e.arguments();
+  Decl_list const& parms = f.parameters();
+  std::size_t n = std::min(exprs.size(), parms.size());
+  push(call_task, e, n);
+  for (std::size_t i = n; i-- > 0; ) {
+    if (!is<Reference_type>(&declared_type(*parms[i])))
+      push(load_task);
+    push(eval_task, *exprs[i]);
+  }
+}
+
+
+// The callee and n arguments are on the stack. Call the function.
+void
+Iterative_evaluator::apply_call(std::size_t n)
+{
+  Function_decl const& f = *values[values.size() - n - 1].get_function();
+  Value_list args(values.end() - n, values.end());
+  values.resize(values.size() - n - 1);
+  enter(f, args);
+}
+
+
+// Enter the function f with the given arguments, scheduling the
+// execution of its definition.
+void
+Iterative_evaluator::enter(Function_decl const& f, Value_list const& args)
+{
+  if (!f.is_definition())
+    instantiate_definition(*cxt, modify(f));
+
+  Activation act {&f, 0, values.size(), frame, stack.mark(), false, {}};
+  if (memoize(f, args, act.key)) {
+    if (Value* v = cxt->calls.find(act.key)) {
+      values.push_back(*v);
+      return;
+    }
+    act.memo = true;
+  }
+  if (calls.size() >= depth_limit)
+    throw Evaluation_error("evaluation exceeded the call depth limit");
+
+  Function_def const& def = prepare(f);
+  frame = stack.allocate(f.frame);
+  bind(f, args);
+
+  // Returning discards the caller's tasks above this point.
+  push(leave_task, f);
+  act.tasks = tasks.size() - 1;
+  calls.push_back(std::move(act));
+  push(exec_task, def.statement());
+}
+
+
+// Return the value v from the current call.
+void
+Iterative_evaluator::leave(Value v)
+{
+  Activation& act = calls.back();
+
+  // A reference to a local object does not outlive the call.
+  if (v.is_reference() && !is<Reference_type>(&act.fn->return_type()))
+    v = *v.get_reference();
+
+  if (act.memo)
+    cxt->calls.insert(act.key, v);
+  tasks.resize(act.tasks);
+  values.resize(act.values);
+  values.push_back(v);
+  frame = act.frame;
+  stack.release(act.mark);
+  calls.pop_back();
+}
+
+
+void
+Iterative_evaluator::exec(Stmt const& s)
+{
+  struct fn
+  {
+    Iterative_evaluator& self;
+
+    void operator()(Stmt const& s) { banjo_unhandled_case(s); }
+
+    // Statements are executed in order, so they are pushed in
+    // reverse.
+    void operator()(Compound_stmt const& s)
+    {
+      std::vector<Stmt*> const& ss = s.statements().base();
+      for (auto iter = ss.rbegin(); iter != ss.rend(); ++iter)
+        self.push(exec_task, **iter);
+    }
+
+    // An object is initialized after its initializer is evaluated.
+    void operator()(Declaration_stmt const& s)
+    {
+      Object_decl const* var = as<Object_decl>(&s.declaration());
+      if (!var || !var->init)
+        return self.elaborate(s.declaration());
+      self.push(init_task, *var);
+      self.push(load_task);
+      self.push(eval_task, *var->init);
+    }
+
+    void operator()(Expression_stmt const& s)
+    {
+      self.push(discard_task);
+      self.push(eval_task, s.expression());
+    }
+
+    void operator()(Return_stmt const& s)
+    {
+      self.push(return_task);
+      self.push(eval_task, s.expression());
+    }
+  };
+  apply(s, fn{*this});
+}
+
+
+// -------------------------------------------------------------------------- //
+// Purity
+
+namespace
+{
+
+// Determines whether functions are pure. A function is pure if it
+// has a definition, its parameters and result are values, and its
+// definition refers only to its own parameters and local variables,
+// modifies nothing, and calls only pure functions.
+//
+// The analysis is optimistic: a function is assumed to be pure while
+// its definition is analyzed, so that recursive functions can be pure.
+// When a function is found to be impure, the assumptions made along
+// the way may be invalid. They are discarded, and the analysis is
+// repeated with the knowledge that the function is impure.
+struct Purity
+{
+  Purity(Context& c)
+    : cxt(c), failed(false)
+  { }
+
+  bool function(Function_decl const&);
+  bool definition(Function_decl const&);
+  bool statement(Stmt const&);
+  bool expression(Expr const&);
+
+  Context&                          cxt;
+  std::vector<Function_decl const*> assumed;
+  bool                              failed;
+};
+
+
+bool
+Purity::function(Function_decl const& f)
+{
+  Memo_table<Function_decl const*, bool>& memo = cxt.calls.purity;
+  if (bool* b = memo.find(&f))
+    return *b;
+  memo.insert(&f, true);
+  assumed.push_back(&f);
+  if (!definition(f)) {
+    memo.insert(&f, false);
+    failed = true;
+    return false;
+  }
+  return true;
+}
+
+
+bool
+Purity::definition(Function_decl const& f)
+{
+  if (!f.is_definition())
+    return false;
+  Function_def const* def = as<Function_def>(&f.definition());
+  if (!def)
+    return false;
+  if (is<Reference_type>(&f.return_type()))
+    return false;
+  for (Decl const& p : f.parameters())
+    if (!is<Object_parm>(&p) || is<Reference_type>(&declared_type(p)))
+      return false;
+
+  // References to parameters and locals are identified by their
+  // slots.
+  if (f.frame < 0)
+    allocate_frame(modify(f));
+  return statement(def->statement());
+}
+
+
+bool
+Purity::statement(Stmt const& s)
+{
+  struct fn
+  {
+    Purity& self;
+
+    bool operator()(Stmt const& s) { return false; }
+
+    bool operator()(Compound_stmt const& s)
+    {
+      for (Stmt const& s1 : s.statements())
+        if (!self.statement(s1))
+          return false;
+      return true;
+    }
+
+    bool operator()(Declaration_stmt const& s)
+    {
+      Variable_decl const* var = as<Variable_decl>(&s.declaration());
+      if (!var || var->slot < 0)
+        return false;
+      return !var->init || self.expression(*var->init);
+    }
+
+    bool operator()(Expression_stmt const& s) { return self.expression(s.expression()); }
+    bool operator()(Return_stmt const& s)     { return self.expression(s.expression()); }
+  };
+  return apply(s, fn{*this});
+}
+
+
+bool
+Purity::expression(Expr const& e)
+{
+  struct fn
+  {
+    Purity& self;
+
+    bool operator()(Expr const& e)         { return false; }
+    bool operator()(Boolean_expr const& e) { return true; }
+    bool operator()(Integer_expr const& e) { return true; }
+    bool operator()(Assign_expr const& e)  { return false; }
+
+    // Only local objects can be referred to.
+    bool operator()(Reference_expr const& e)
+    {
+      Decl const& d = e.declaration();
+      if (Object_decl const* var = as<Object_decl>(&d))
+        return var->slot >= 0;
+      return is<Function_decl>(&d);
+    }
+
+    bool operator()(Unary_expr const& e)
+    {
+      return self.expression(e.operand());
+    }
+
+    bool operator()(Binary_expr const& e)
+    {
+      return self.expression(e.left()) && self.expression(e.right());
+    }
+
+    bool operator()(Conv const& e)
+    {
+      return self.expression(e.source());
+    }
+
+    bool operator()(Call_expr const& e)
+    {
+      Reference_expr const* ref = as<Reference_expr>(&e.function());
+      if (!ref)
+        return false;
+      Function_decl const* f = as<Function_decl>(&ref->declaration());
+      if (!f || !self.function(*f))
+        return false;
+      for (Expr const& a : e.arguments())
+        if (!self.expression(a))
+          return false;
+      return true;
+    }
+  };
+  return apply(e, fn{*this});
+}
+
+
+} // namespace
+
+
+// Returns true if calls to `f` have no side effects and their results
+// depend only on their arguments.
+bool
+is_pure(Context& cxt, Function_decl const& f)
+{
+  while (true) {
+    Purity p(cxt);
+    bool result = p.function(f);
+    if (!p.failed)
+      return result;
+
+    // Discard the assumptions made during the analysis. Functions
+    // found to be impure are remembered.
+    for (Function_decl const* g : p.assumed) {
+      auto iter = cxt.calls.purity.map.find(g);
+      if (iter->second)
+        cxt.calls.purity.map.erase(iter);
+    }
+    if (!result)
+      return false;
+  }
+}
+
+
+// -------------------------------------------------------------------------- //
+// Constant evaluation
+
+// Evaluate the constant expression e using the engine selected by
+// the context.
+Value
+evaluate_constant(Context& cxt, Expr const& e)
+{
+  switch (cxt.evaluation.engine) {
+    case recursive_engine:
+      return evaluate(cxt, e);
+    case iterative_engine:
+      return evaluate_iteratively(cxt, e);
+    case compiled_engine:
+      return execute(cxt, e);
+  }
+  lingo_unreachable();
 }
 
 
@@ -340,7 +1096,7 @@ reduce(Context& cxt, Expr& e)
     Expr& operator()(Tuple_value const& v)     { lingo_unimplemented(); }
 
   };
-  return apply(evaluate(e), fn{cxt, e.type()});
+  return apply(evaluate_constant(cxt, e), fn{cxt, e.type()});
 }
 
 
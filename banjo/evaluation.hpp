@@ -9,27 +9,41 @@
 #include "context.hpp"
 #include "value.hpp"
 
-#include <lingo/environment.hpp>
+#include <cstdint>
+#include <vector>
 
 
 namespace banjo
 {
 
-// TODO: Specialize the store and call stack to use load and store
-// instead of lookup and bind. That's a bit more conventional for
-// the kinds of operations here.
+// The call stack holds the values of the parameters and local
+// variables of active calls. Each call allocates a frame with one
+// value for each slot assigned to the function (see allocate_frame).
+// Objects are accessed by indexing the frame with their slot.
+//
+// Frames are allocated contiguously within large blocks. Blocks are
+// never reallocated, so references to objects in a frame remain
+// valid while the frame is active.
+struct Call_stack
+{
+  // A position in the stack, to which it can be restored.
+  using Mark = std::pair<std::size_t, std::size_t>;
 
+  static constexpr std::size_t block_size = 1024;
 
-// Dynamic binding of declarations to their values.
-using Store = Environment<Decl const*, Value>;
+  Call_stack()
+    : block(0), used(0)
+  { }
 
+  Mark mark() const     { return {block, used}; }
+  void release(Mark m)  { block = m.first; used = m.second; }
 
-// The store stack maintains the dynamic binding between symbols
-// and their values. Each time a new binding environment is entered
-// (e.g., a block scope), a new frame is created to store bindings.
-//
-// This is also the call stack.
-using Call_stack = Stack<Store>;
+  Value* allocate(std::size_t);
+
+  std::vector<std::vector<Value>> blocks;
+  std::size_t                     block;
+  std::size_t                     used;
+};
 
 
 // Represents the evaluation of a statement. This determines the
@@ -48,9 +62,20 @@ enum Control
 struct Evaluator
 {
 public:
+  Evaluator()
+    : cxt(nullptr), frame(nullptr)
+  { }
+
+  // When evaluating with a context, the definitions of template
+  // specializations are instantiated on demand.
+  Evaluator(Context& c)
+    : cxt(&c), frame(nullptr)
+  { }
+
   Value operator()(Expr const& e)           { return evaluate(e); }
 
   Value evaluate(Expr const&);
+  Value evaluate_value(Expr const&);
   Value evaluate_boolean(Boolean_expr const&);
   Value evaluate_integer(Integer_expr const&);
   Value evaluate_reference(Reference_expr const&);
@@ -58,6 +83,18 @@ public:
   Value evaluate_and(And_expr const&);
   Value evaluate_or(Or_expr const&);
   Value evaluate_not(Not_expr const&);
+  Value evaluate_neg(Neg_expr const&);
+  Value evaluate_conversion(Conv const&);
+
+  template<typename Op>
+  Value evaluate_binary(Binary_expr const&, Op);
+
+  Value call(Function_decl const&, Value_list const&);
+  Value invoke(Function_decl const&, Value_list const&);
+
+  bool                memoize(Function_decl const&, Value_list const&, Call_cache::Key&);
+  Function_def const& prepare(Function_decl const&);
+  void                bind(Function_decl const&, Value_list const&);
 
   Control evaluate(Stmt const&, Value&);
   Control evaluate_block(Compound_stmt const&, Value&);
@@ -69,6 +106,7 @@ public:
   void elaborate_object(Object_decl const&);
 
   // Memory management
+  Value& local(Decl const&);
   Value  alias(Decl const&);
   Value  load(Decl const&);
   Value& store(Decl const&, Value const&);
@@ -76,28 +114,187 @@ public:
 
   struct Enter_frame;
 
+  Context*   cxt;
   Call_stack stack;
+  Value*     frame; // The frame of the current call
 };
 
 
-// A helper class for managing stack frames.
+// A helper class for managing stack frames. This allocates a
+// frame of n values for the duration of a call.
 struct Evaluator::Enter_frame
 {
-  Enter_frame(Evaluator& e)
-    : eval(e)
+  Enter_frame(Evaluator& e, std::size_t n)
+    : eval(e), mark(e.stack.mark()), prev(e.frame)
   {
-    eval.stack.push();
+    eval.frame = eval.stack.allocate(n);
   }
 
   ~Enter_frame()
   {
-    eval.stack.pop();
+    eval.frame = prev;
+    eval.stack.release(mark);
   }
 
-  Evaluator& eval;
+  Evaluator&       eval;
+  Call_stack::Mark mark;
+  Value*           prev;
 };
 
 
+// -------------------------------------------------------------------------- //
+// Iterative evaluation
+
+// The kinds of work performed by the iterative evaluator.
+enum Task_kind
+{
+  eval_task,    // Evaluate an expression, pushing its value
+  load_task,    // Replace a reference on the value stack by its value
+  apply_task,   // Apply an operator to the values of its operands
+  branch_task,  // Decide whether to evaluate the right operand of && or ||
+  args_task,    // Evaluate the arguments of a call
+  call_task,    // Call a function with the evaluated arguments
+  exec_task,    // Execute a statement
+  init_task,    // Initialize an object with the value on the stack
+  discard_task, // Discard the value of an expression statement
+  return_task,  // Return the value of a return statement
+  leave_task,   // The end of a function was reached
+};
+
+
+// A unit of pending work for a term. For a call, n is the number of
+// evaluated arguments.
+struct Task
+{
+  Task_kind   kind;
+  Term const* term;
+  std::size_t n;
+};
+
+
+// The state of an active call.
+struct Activation
+{
+  Function_decl const* fn;
+  std::size_t          tasks;  // Pending tasks of the caller
+  std::size_t          values; // Values of the caller
+  Value*               frame;  // The frame of the caller
+  Call_stack::Mark     mark;   // The stack of the caller
+  bool                 memo;   // True if the result is memoized
+  Call_cache::Key      key;
+};
+
+
+// An evaluator that does not recurse on the native stack. Pending
+// work is kept in a stack of tasks, intermediate results in a stack
+// of values, and active calls in a stack of activations. This can
+// evaluate deeply recursive functions, and evaluation fails cleanly
+// when it takes too many steps or calls are nested too deeply.
+//
+// Native code is not used, since compiled functions recurse on the
+// native stack.
+struct Iterative_evaluator : Evaluator
+{
+  // The limits are initially those of the context.
+  Iterative_evaluator(Context& c)
+    : Evaluator(c)
+    , step_limit(c.evaluation.step_limit)
+    , depth_limit(c.evaluation.depth_limit)
+  { }
+
+  Value operator()(Expr const& e) { return run(e); }
+
+  Value run(Expr const&);
+
+  void step(Task const&);
+  void eval(Expr const&);
+  void exec(Stmt const&);
+  void apply_operator(Expr const&);
+  void branch(Binary_expr const&);
+  void arguments(Call_expr const&);
+  void apply_call(std::size_t);
+  void enter(Function_decl const&, Value_list const&);
+  void leave(Value);
+
+  void push(Task_kind k, Term const& t, std::size_t n = 0) { tasks.push_back({k, &t, n}); }
+  void push(Task_kind k)                                   { tasks.push_back({k, nullptr, 0}); }
+
+  Value pop()
+  {
+    Value v = values.back();
+    values.pop_back();
+    return v;
+  }
+
+  // The maximum number of tasks performed by a single evaluation.
+  std::size_t step_limit;
+
+  // The maximum number of nested calls.
+  std::size_t depth_limit;
+
+  std::vector<Task>       tasks;
+  std::vector<Value>      values;
+  std::vector<Activation> calls;
+};
+
+
+// -------------------------------------------------------------------------- //
+// Integer arithmetic
+//
+// These operations are shared by all evaluators so that they produce
+// identical results. Arithmetic wraps on overflow. Division by zero
+// is an evaluation error.
+
+inline Integer_value
+add_integers(Integer_value a, Integer_value b)
+{
+  return Integer_value(std::uint64_t(a) + std::uint64_t(b));
+}
+
+
+inline Integer_value
+sub_integers(Integer_value a, Integer_value b)
+{
+  return Integer_value(std::uint64_t(a) - std::uint64_t(b));
+}
+
+
+inline Integer_value
+mul_integers(Integer_value a, Integer_value b)
+{
+  return Integer_value(std::uint64_t(a) * std::uint64_t(b));
+}
+
+
+inline Integer_value
+div_integers(Integer_value a, Integer_value b)
+{
+  if (b == 0)
+    throw Evaluation_error("division by zero");
+  if (b == -1)
+    return Integer_value(0 - std::uint64_t(a));
+  return a / b;
+}
+
+
+inline Integer_value
+rem_integers(Integer_value a, Integer_value b)
+{
+  if (b == 0)
+    throw Evaluation_error("division by zero");
+  if (b == -1)
+    return 0;
+  return a % b;
+}
+
+
+inline Integer_value
+neg_integer(Integer_value a)
+{
+  return Integer_value(0 - std::uint64_t(a));
+}
+
+
 // -------------------------------------------------------------------------- //
 // Expression evaluation
 
@@ -110,6 +307,32 @@ evaluate(Expr const& e)
 }
 
 
+// Evaluate the given expression, instantiating definitions as
+// needed.
+inline Value
+evaluate(Context& cxt, Expr const& e)
+{
+  Evaluator eval(cxt);
+  return eval(e);
+}
+
+
+bool is_pure(Context&, Function_decl const&);
+
+
+// Evaluate the given expression without recursion on the native
+// stack, using the limits of the context.
+inline Value
+evaluate_iteratively(Context& cxt, Expr const& e)
+{
+  Iterative_evaluator eval(cxt);
+  return eval(e);
+}
+
+
+Value evaluate_constant(Context&, Expr const&);
+
+
 Expr const& reduce(Context&, Expr const&);
 Expr&       reduce(Context&, Expr&);
 
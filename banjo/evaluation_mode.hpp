@@ -0,0 +1,59 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_EVALUATION_MODE_HPP
+#define BANJO_EVALUATION_MODE_HPP
+
+#include "prelude.hpp"
+
+
+namespace banjo
+{
+
+// The algorithms used to evaluate constant expressions (e.g., the
+// predicates of constraints).
+//
+// The recursive engine interprets expressions and definitions on
+// the native stack.
+//
+// The iterative engine keeps its pending work on the heap. Deep
+// recursion in evaluated code does not exhaust the native stack;
+// evaluation fails with an Evaluation_error when it exceeds the
+// step or depth limit.
+//
+// The compiled engine executes expressions as bytecode (see
+// execute). Expressions that cannot be compiled are evaluated by
+// the recursive engine.
+enum Evaluation_engine
+{
+  recursive_engine,
+  iterative_engine,
+  compiled_engine,
+};
+
+
+// Selects the engine used to evaluate constant expressions, and
+// the limits of the iterative engine. See evaluate_constant.
+//
+// Compiled evaluation is opt-in; it is enabled by selecting the
+// compiled engine.
+struct Evaluation_mode
+{
+  Evaluation_mode()
+    : engine(recursive_engine), step_limit(1 << 26), depth_limit(1 << 18)
+  { }
+
+  Evaluation_engine engine;
+
+  // The maximum number of tasks performed by a single evaluation.
+  std::size_t step_limit;
+
+  // The maximum number of nested calls.
+  std::size_t depth_limit;
+};
+
+
+} // namespace banjo
+
+
+#endif
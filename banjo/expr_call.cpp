@@ -11,6 +11,7 @@
 #include "constraint.hpp"
 #include "lookup.hpp"
 #include "deduction.hpp"
+#include "normalization.hpp"
 #include "subsumption.hpp"
 #include "print.hpp"
 
@@ -30,12 +31,12 @@ make_dependent_template_call(Context& cxt, Template_ref& e, Expr_list& args)
 
   // FIXME: Factor this into smaller bits. We'll need it when we try
   // to handle overloads.
-  if (Function_decl* f = as<Function_decl>(&pd)) {
+  if (is<Function_decl>(&pd)) {
     // Perform template argument deduction using the parameters of
     // the function template and the given arguments.
     Substitution sub(temp.parameters());
     try {
-      deduce_from_call(cxt, f->parameters(), args, sub);
+      deduce_from_call(cxt, temp, args, sub);
       Decl& tspec = specialize_template(cxt, temp, sub);
       Function_decl& spec = cast<Function_decl>(tspec);
       Type& t = spec.return_type();
@@ -47,8 +48,8 @@ make_dependent_template_call(Context& cxt, Template_ref& e, Expr_list& args)
       //
       // TODO: Do this here, or in specialize_template?
       if (temp.is_constrained()) {
-        Expr& fcons = temp.constraint();
-        Expr& ccons = *cxt.current_template_constraints();
+        Cons& fcons = normalize(cxt, temp);
+        Cons& ccons = normalize(cxt, *cxt.current_template_constraints());
 
         // The call is admissible iff the current constraints subsume
         // those of the the candidate function.
@@ -89,8 +90,7 @@ make_dependent_call(Context& cxt, Expr& e, Expr_list& args)
     return init;
 
   // Determine if the constraints explicitly admit this declaration.
-  Expr& cons = *cxt.current_template_constraints();
-  if (Expr* ret = admit_expression(cxt, cons, init))
+  if (Expr* ret = admit_expression(cxt, cxt.current_admissions(), init))
     return *ret;
 
   // Otherwise, e refers to a previous declaration, possibly many.
@@ -4,6 +4,7 @@
 #include "expression.hpp"
 #include "ast.hpp"
 #include "template.hpp"
+#include "instantiation.hpp"
 #include "context.hpp"
 #include "lookup.hpp"
 #include "print.hpp"
@@ -29,6 +30,8 @@ make_reference(Context& cxt, Decl& d)
     return cxt.make_reference(*v);
   if (Object_parm* p = as<Object_parm>(&d))
     return cxt.make_reference(*p);
+  if (Value_parm* p = as<Value_parm>(&d))
+    return cxt.make_reference(*p);
   if (Function_decl* f = as<Function_decl>(&d))
     return cxt.make_reference(*f);
 
@@ -81,6 +84,11 @@ make_reference(Context& cxt, Template_id& id)
   Template_decl& tmp = id.declaration();
   Term_list& args = id.arguments();
   Decl& d = specialize_template(cxt, tmp, args);
+
+  // Outside of a template, a reference to a specialization requires
+  // its definition.
+  if (!cxt.in_template())
+    require_definition(cxt, d);
   return make_reference(cxt, d);
 }
 
@@ -51,8 +51,7 @@ make_dependent_logical_expr(Context& cxt, Expr& e, Make make)
 
   // Inside a constrained template, search the constraints to determine
   // if the expression is admissible.
-  Expr& con = *cxt.current_template_constraints();
-  if (Expr* ret = admit_expression(cxt, con, init))
+  if (Expr* ret = admit_expression(cxt, cxt.current_admissions(), init))
     return *ret;
 
   // If no no such expression is admitted by the constraints, then
@@ -131,8 +130,7 @@ make_dependent_logical_expr(Context& cxt, Expr& e1, Expr& e2, Make make)
 
   // Inside a constrained template, search the constraints to determine
   // if the expression is admissible.
-  Expr& con = *cxt.current_template_constraints();
-  if (Expr* ret = admit_expression(cxt, con, init))
+  if (Expr* ret = admit_expression(cxt, cxt.current_admissions(), init))
     return *ret;
 
   // If no no such expression is admitted by the constraints, then
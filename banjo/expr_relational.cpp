@@ -53,8 +53,7 @@ make_dependent_relational_expr(Context& cxt, Expr& e1, Expr& e2, Make make)
 
   // Inside a constrained template, search the constraints to
   // determine if the expression is admissible.
-  Expr& con = *cxt.current_template_constraints();
-  if (Expr* ret = admit_expression(cxt, con, init))
+  if (Expr* ret = admit_expression(cxt, cxt.current_admissions(), init))
     return *ret;
 
   // Search for dependent conversions.
@@ -16,8 +16,10 @@ namespace banjo
 Expr&
 make_required_expression(Context& cxt, Expr& e)
 {
-  if (Expr* prev = requirement_lookup(cxt, e))
+  if (Expr* prev = requirement_lookup(cxt, e)) {
     e.ty = prev->ty;
+    set_dependence(e);
+  }
   return e;
 }
 
@@ -29,6 +29,7 @@ Expr& make_ge(Context&, Expr&, Expr&);
 Expr& make_call(Context& cxt, Expr& e, Expr_list&);
 
 Expr& make_reference(Context& cxt, Name&);
+Expr& make_reference(Context& cxt, Decl&);
 
 Expr& make_requirements(Context& cxt, Decl_list const&, Decl_list const&, Req_list const&);
 
@@ -0,0 +1,75 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_FACTORY_HPP
+#define BANJO_FACTORY_HPP
+
+#include "prelude.hpp"
+#include "arena.hpp"
+#include "hash.hpp"
+#include "equivalence.hpp"
+
+#include <unordered_set>
+
+
+namespace banjo
+{
+
+// A unique factory will only allocate new objects if an equivalent
+// object has not been previously created. New objects are allocated
+// in the given arena, so the factory must not outlive it. Typically,
+// both are owned by the context.
+//
+// Note that the factory stores pointers, so it can be declared
+// before T is complete. A factory can hold objects of several kinds
+// derived from T, as long as Eq never equates objects of different
+// kinds.
+template<typename T, typename Hash = Term_hash<T>, typename Eq = Term_eq<T>>
+struct Unique_factory : std::unordered_set<T*, Hash, Eq>
+{
+  template<typename U = T, typename... Args>
+  U& make(Arena&, Args&&...);
+};
+
+
+// Returns the unique object constructed over args. A temporary is
+// used as the search key; it is copied into the arena only when no
+// equivalent object exists.
+template<typename T, typename Hash, typename Eq>
+template<typename U, typename... Args>
+U&
+Unique_factory<T, Hash, Eq>::make(Arena& a, Args&&... args)
+{
+  U key(std::forward<Args>(args)...);
+  set_kind(key);
+  auto iter = this->find(&key);
+  if (iter != this->end())
+    return static_cast<U&>(**iter);
+  U& u = a.make<U>(std::move(key));
+  this->insert(&u);
+  return u;
+}
+
+
+// Hashing and comparison for the table of canonical types. The
+// components of a canonical type are canonical, so they are compared
+// by identity and not recursively. These are defined in builder.cpp.
+struct Canonical_type_hash
+{
+  std::size_t operator()(Type const*) const;
+};
+
+
+struct Canonical_type_eq
+{
+  bool operator()(Type const*, Type const*) const;
+};
+
+
+using Type_factory = Unique_factory<Type, Canonical_type_hash, Canonical_type_eq>;
+
+
+} // namespace banjo
+
+
+#endif
@@ -4,16 +4,30 @@
 #include "hash.hpp"
 #include "ast.hpp"
 
-#include <typeinfo>
-
 namespace banjo
 {
 
-// Returns an initial hash value based on the dynamic type of T.
+// Returns an initial hash value based on the kind of t.
 template<typename T>
 std::size_t hash_type(T const& t)
 {
-  return typeid(t).hash_code();
+  return kind_of(t);
+}
+
+
+// Returns the hash value of x, which is computed by applying f
+// only the first time it is requested. The hashed parts of names,
+// types, expressions, and constraints do not change after
+// construction, so the cached value remains valid. Because the
+// hash of a term is combined from those of its operands, which
+// are also cached, each node is hashed at most once.
+template<typename T, typename F>
+inline std::size_t
+cached_hash(T const& x, F f)
+{
+  if (!x.hash)
+    x.hash = apply(x, f);
+  return x.hash;
 }
 
 
@@ -24,13 +38,13 @@ std::size_t hash_type(T const& t)
 std::size_t
 hash_value(Term const& x)
 {
-  if (Name const* n = as<Name>(&x))
+  if (Name const* n = dyn_cast<Name>(&x))
     return hash_value(*n);
-  if (Type const* t = as<Type>(&x))
+  if (Type const* t = dyn_cast<Type>(&x))
     return hash_value(*t);
-  if (Expr const* e = as<Expr>(&x))
+  if (Expr const* e = dyn_cast<Expr>(&x))
     return hash_value(*e);
-  if (Decl const* d = as<Decl>(&x))
+  if (Decl const* d = dyn_cast<Decl>(&x))
     return hash_value(*d);
   lingo_unreachable();
 }
@@ -130,7 +144,7 @@ hash_value(Name const& n)
     std::size_t operator()(Concept_id const& n)     { return hash_value(n); }
     std::size_t operator()(Qualified_id const& n)   { return hash_value(n); }
   };
-  return apply(n, fn{});
+  return cached_hash(n, fn{});
 }
 
 
@@ -245,7 +259,7 @@ hash_value(Type const& t)
     std::size_t operator()(Typename_type const& t) const  { return hash_udt(t); }
     std::size_t operator()(Synthetic_type const& t) const { return hash_udt(t); }
   };
-  return apply(t, fn{});
+  return cached_hash(t, fn{});
 }
 
 
@@ -313,7 +327,7 @@ hash_value(Expr const& e)
     std::size_t operator()(Binary_expr const& e) const    { return hash_value(e); }
     std::size_t operator()(Call_expr const& e) const      { return hash_value(e); }
   };
-  return apply(e, fn{});
+  return cached_hash(e, fn{});
 }
 
 
@@ -419,7 +433,7 @@ hash_value(Cons const& c)
     std::size_t operator()(Parameterized_cons const& c) const { return hash_parm(c); }
     std::size_t operator()(Binary_cons const& c) const    { return hash_value(c); }
   };
-  return apply(c, fn{});
+  return cached_hash(c, fn{});
 }
 
 
@@ -36,7 +36,7 @@ hash_value(List<T> const& list)
 template<typename T>
 struct Term_hash
 {
-  bool operator()(T const* t) const
+  std::size_t operator()(T const* t) const
   {
     return hash_value(*t);
   }
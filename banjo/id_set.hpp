@@ -0,0 +1,173 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_ID_SET_HPP
+#define BANJO_ID_SET_HPP
+
+#include "prelude.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+
+namespace banjo
+{
+
+// A set of small, non-negative integers, represented as a bit vector.
+// This is intended for sets of dense ids (e.g., the ids of unique
+// constraints), where membership is a bit test, and union, subset,
+// and intersection tests operate on a word at a time.
+//
+// The vector grows to hold the largest inserted id. Trailing zero
+// words are not significant, so sets of different lengths compare
+// equal when they have the same elements.
+struct Id_set
+{
+  using Word = std::uint64_t;
+
+  static constexpr int word_bits = 64;
+
+  // Returns true if n is in the set.
+  bool contains(int n) const
+  {
+    std::size_t w = word(n);
+    return w < words.size() && (words[w] & bit(n));
+  }
+
+  // Insert n into the set. Returns false if n was already present.
+  bool insert(int n)
+  {
+    lingo_assert(n >= 0);
+    std::size_t w = word(n);
+    if (w >= words.size())
+      words.resize(w + 1, 0);
+    if (words[w] & bit(n))
+      return false;
+    words[w] |= bit(n);
+    return true;
+  }
+
+  // Remove n from the set. Returns false if n was not present.
+  bool erase(int n)
+  {
+    std::size_t w = word(n);
+    if (w >= words.size() || !(words[w] & bit(n)))
+      return false;
+    words[w] &= ~bit(n);
+    return true;
+  }
+
+  // Remove all elements from the set.
+  void clear() { words.clear(); }
+
+  // Adds the elements of s to this set.
+  Id_set& operator|=(Id_set const& s)
+  {
+    if (words.size() < s.words.size())
+      words.resize(s.words.size(), 0);
+    for (std::size_t i = 0; i < s.words.size(); ++i)
+      words[i] |= s.words[i];
+    return *this;
+  }
+
+  // Removes the elements not in s from this set.
+  Id_set& operator&=(Id_set const& s)
+  {
+    if (words.size() > s.words.size())
+      words.resize(s.words.size());
+    for (std::size_t i = 0; i < words.size(); ++i)
+      words[i] &= s.words[i];
+    return *this;
+  }
+
+  // Returns true if every element of this set is in s.
+  bool is_subset_of(Id_set const& s) const
+  {
+    for (std::size_t i = 0; i < words.size(); ++i) {
+      Word w = i < s.words.size() ? s.words[i] : 0;
+      if (words[i] & ~w)
+        return false;
+    }
+    return true;
+  }
+
+  // Returns true if this set and s have an element in common.
+  bool intersects(Id_set const& s) const
+  {
+    std::size_t n = std::min(words.size(), s.words.size());
+    for (std::size_t i = 0; i < n; ++i)
+      if (words[i] & s.words[i])
+        return true;
+    return false;
+  }
+
+  // Returns true if the set has no elements.
+  bool empty() const
+  {
+    for (Word w : words)
+      if (w)
+        return false;
+    return true;
+  }
+
+  // Returns the number of elements in the set.
+  std::size_t size() const
+  {
+    std::size_t n = 0;
+    for (Word w : words)
+      n += std::bitset<word_bits>(w).count();
+    return n;
+  }
+
+  // Call f(n) for each element n of the set, in increasing order.
+  template<typename F>
+  void for_each(F f) const
+  {
+    for (std::size_t i = 0; i < words.size(); ++i) {
+      for (Word w = words[i]; w; w &= w - 1) {
+        int b = int(std::bitset<word_bits>((w & -w) - 1).count());
+        f(int(i) * word_bits + b);
+      }
+    }
+  }
+
+  friend bool operator==(Id_set const& a, Id_set const& b)
+  {
+    return a.is_subset_of(b) && b.is_subset_of(a);
+  }
+
+  friend bool operator!=(Id_set const& a, Id_set const& b)
+  {
+    return !(a == b);
+  }
+
+  std::vector<Word> words;
+
+private:
+  static std::size_t word(int n) { return std::size_t(n) / word_bits; }
+  static Word        bit(int n)  { return Word(1) << (n % word_bits); }
+};
+
+
+// Returns the union of a and b.
+inline Id_set
+operator|(Id_set a, Id_set const& b)
+{
+  return a |= b;
+}
+
+
+// Returns the intersection of a and b.
+inline Id_set
+operator&(Id_set a, Id_set const& b)
+{
+  return a &= b;
+}
+
+
+} // namespace banjo
+
+
+#endif
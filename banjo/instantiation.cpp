@@ -0,0 +1,123 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "instantiation.hpp"
+#include "ast.hpp"
+#include "context.hpp"
+#include "declaration.hpp"
+#include "substitution.hpp"
+
+
+namespace banjo
+{
+
+// Note that the definition of the specialization d is needed. If d
+// is a specialization whose definition has not been requested, it is
+// added to the worklist.
+//
+// TODO: Instantiate the definitions of variable and class template
+// specializations.
+void
+require_definition(Context& cxt, Decl& d)
+{
+  Instantiation_queue& q = cxt.instantiations;
+  Instantiation* inst = q.origin(d);
+  if (!inst || inst->state != Instantiation::declared)
+    return;
+  if (!is<Function_decl>(&d))
+    return;
+  inst->state = Instantiation::pending;
+  q.work.push_back(&d);
+  ++q.nrequests;
+}
+
+
+namespace
+{
+
+// Instantiate the definition of the function specialization f by
+// substituting the template arguments into the definition of the
+// template's pattern. Returns false if the pattern is not (yet)
+// defined.
+bool
+instantiate_function(Context& cxt, Instantiation& inst, Function_decl& f)
+{
+  Template_decl& tmp = *inst.tmp;
+  Function_decl& pat = cast<Function_decl>(tmp.parameterized_declaration());
+  if (!pat.is_definition())
+    return false;
+
+  // The definition is instantiated in the scope enclosing the
+  // template, which is the global namespace unless the template
+  // belongs to some other namespace.
+  Namespace_decl* ns = as<Namespace_decl>(tmp.context());
+  if (!ns)
+    ns = &cxt.global_namespace();
+  Enter_scope nscope(cxt, *ns);
+
+  // References to the parameters of the pattern are rebound to
+  // the parameters of the specialization.
+  Substitution sub(tmp.parameters(), inst.args);
+  Enter_scope fscope(cxt, cxt.make_function_scope(f));
+  auto pi = pat.parameters().begin();
+  for (Decl& p : f.parameters()) {
+    declare(cxt, p);
+    sub.rebind(*pi++, p);
+  }
+  f.def = &substitute(cxt, pat.definition(), sub);
+  allocate_frame(f);
+  return true;
+}
+
+
+} // namespace
+
+
+// Instantiate the definition of the specialization d, if it has
+// not already been instantiated. Returns true if d has an instantiated
+// definition.
+bool
+instantiate_definition(Context& cxt, Decl& d)
+{
+  Instantiation_queue& q = cxt.instantiations;
+  Instantiation* inst = q.origin(d);
+  if (!inst)
+    return false;
+  if (inst->state == Instantiation::instantiated)
+    return true;
+
+  Function_decl* f = as<Function_decl>(&d);
+  if (!f || !instantiate_function(cxt, *inst, *f))
+    return false;
+  inst->state = Instantiation::instantiated;
+  ++q.ninstantiated;
+  return true;
+}
+
+
+// Instantiate all pending definitions. Instantiating a definition
+// may require further definitions; those are instantiated in the
+// same pass. Returns the number of definitions instantiated.
+std::size_t
+instantiate_pending(Context& cxt)
+{
+  Instantiation_queue& q = cxt.instantiations;
+  std::size_t n = 0;
+  while (!q.empty()) {
+    Decl& d = *q.work.front();
+    q.work.pop_front();
+
+    // The definition may have been instantiated on demand.
+    if (q.origin(d)->state == Instantiation::instantiated)
+      continue;
+
+    if (n == q.limit)
+      throw Limitation_error("exceeded instantiation limit");
+    if (instantiate_definition(cxt, d))
+      ++n;
+  }
+  return n;
+}
+
+
+} // namespace banjo
@@ -0,0 +1,91 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_INSTANTIATION_HPP
+#define BANJO_INSTANTIATION_HPP
+
+#include "prelude.hpp"
+#include "language.hpp"
+
+#include <deque>
+#include <unordered_map>
+
+
+namespace banjo
+{
+
+// Records the template and arguments from which a specialization
+// was produced, and the state of its definition.
+struct Instantiation
+{
+  enum State
+  {
+    declared,     // Only the declaration exists
+    pending,      // The definition is needed
+    instantiated  // The definition has been instantiated
+  };
+
+  Template_decl* tmp;
+  Term_list      args;
+  State          state;
+};
+
+
+// The worklist of pending instantiations.
+//
+// Specializing a template produces only a declaration (see
+// specialize_template). When the definition of a specialization is
+// needed, it is queued here. Each specialization is queued at most
+// once. Pending definitions are instantiated in a single pass at the
+// end of the translation unit, or on demand (e.g., when evaluating
+// a call to the specialization).
+struct Instantiation_queue
+{
+  Instantiation_queue()
+    : limit(1 << 16), nrequests(0), ninstantiated(0)
+  { }
+
+  // Record that d is a specialization of tmp with the given
+  // arguments.
+  void record(Template_decl& tmp, Decl& d, Term_list const& args)
+  {
+    origins.emplace(&d, Instantiation{&tmp, args, Instantiation::declared});
+  }
+
+  // Returns the origin of the specialization d, or nullptr if d is
+  // not a specialization.
+  Instantiation* origin(Decl const& d)
+  {
+    auto iter = origins.find(&d);
+    return iter != origins.end() ? &iter->second : nullptr;
+  }
+
+  // Returns true if no instantiations are pending.
+  bool empty() const { return work.empty(); }
+
+  // Statistics
+  std::size_t pending() const      { return work.size(); }
+  std::size_t requests() const     { return nrequests; }
+  std::size_t instantiated() const { return ninstantiated; }
+
+  std::unordered_map<Decl const*, Instantiation> origins;
+  std::deque<Decl*> work;
+
+  // The maximum number of instantiations in a single pass. This
+  // guards against unbounded recursive instantiation.
+  std::size_t limit;
+
+  std::size_t nrequests;
+  std::size_t ninstantiated;
+};
+
+
+void        require_definition(Context&, Decl&);
+bool        instantiate_definition(Context&, Decl&);
+std::size_t instantiate_pending(Context&);
+
+
+} // namespace banjo
+
+
+#endif
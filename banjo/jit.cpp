@@ -0,0 +1,493 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "jit.hpp"
+#include "ast.hpp"
+#include "bytecode.hpp"
+#include "context.hpp"
+
+#ifdef BANJO_JIT
+#  include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#  include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#  include <llvm/IR/IRBuilder.h>
+#  include <llvm/IR/LLVMContext.h>
+#  include <llvm/IR/Module.h>
+#  include <llvm/IR/Verifier.h>
+#  include <llvm/Support/TargetSelect.h>
+#endif
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace banjo
+{
+
+#ifdef BANJO_JIT
+
+// -------------------------------------------------------------------------- //
+// Lowering
+//
+// Each compiled function f is lowered to a function with the signature
+//
+//    i64 f(i64* err, i64 args...)
+//
+// Registers are stack slots. On error, the code is stored in err and
+// the function returns immediately; callers check err after each
+// call. An entry point taking its arguments as an array is generated
+// for each function called from the evaluator.
+
+
+// The JIT and the names of the functions it has compiled. Compiled
+// functions are shared by later modules.
+struct Jit_engine
+{
+  std::unique_ptr<llvm::orc::LLJIT>                   jit;
+  std::unordered_map<Function_decl const*, std::string> symbols;
+  int                                                 modules = 0;
+};
+
+
+namespace
+{
+
+// Thrown when a function cannot be lowered.
+struct Unsupported { };
+
+
+struct Lowering
+{
+  Lowering(Context& c, Jit_engine& e, llvm::Module& m)
+    : cxt(c), engine(e), mod(m), ir(m.getContext()), ix(ir.getInt64Ty())
+  { }
+
+  llvm::FunctionType* signature(int);
+  llvm::Function*     function(Function_decl const&);
+  llvm::Function*     entry(Function_decl const&);
+  void                define(Function_decl const&, Bytecode&, llvm::Function*);
+
+  // Emit code that stores the error and returns.
+  void fail(llvm::Value* err, Native_error e)
+  {
+    ir.CreateStore(llvm::ConstantInt::get(ix, e), err);
+    ir.CreateRet(llvm::ConstantInt::get(ix, 0));
+  }
+
+  Context&         cxt;
+  Jit_engine&      engine;
+  llvm::Module&    mod;
+  llvm::IRBuilder<> ir;
+  llvm::Type*      ix;
+
+  // Functions declared or defined in this module, and those whose
+  // definitions are needed.
+  std::unordered_map<Function_decl const*, llvm::Function*> fns;
+  std::vector<Function_decl const*>                         work;
+
+  // Symbols defined by this module.
+  std::vector<std::pair<Function_decl const*, std::string>> defined;
+};
+
+
+llvm::FunctionType*
+Lowering::signature(int n)
+{
+  std::vector<llvm::Type*> ps(n + 1, ix);
+  ps[0] = llvm::PointerType::getUnqual(ix);
+  return llvm::FunctionType::get(ix, ps, false);
+}
+
+
+// Returns the function for f, declaring it if needed. Functions that
+// were compiled for earlier modules are declared and linked by the JIT.
+llvm::Function*
+Lowering::function(Function_decl const& f)
+{
+  auto iter = fns.find(&f);
+  if (iter != fns.end())
+    return iter->second;
+
+  Bytecode* bc = get_bytecode(cxt, f);
+  if (!bc)
+    throw Unsupported();
+
+  std::string name;
+  auto sym = engine.symbols.find(&f);
+  if (sym != engine.symbols.end()) {
+    name = sym->second;
+  } else {
+    name = "banjo." + std::to_string(engine.modules) + "." + std::to_string(defined.size());
+    defined.emplace_back(&f, name);
+    work.push_back(&f);
+  }
+  auto linkage = llvm::Function::ExternalLinkage;
+  llvm::Function* fn = llvm::Function::Create(signature(bc->nparms), linkage, name, mod);
+  fns.emplace(&f, fn);
+  return fn;
+}
+
+
+// Define the entry point for f, which takes its arguments as an array.
+llvm::Function*
+Lowering::entry(Function_decl const& f)
+{
+  llvm::Function* fn = function(f);
+  llvm::Type* px = llvm::PointerType::getUnqual(ix);
+  llvm::FunctionType* type = llvm::FunctionType::get(ix, {px, px}, false);
+  auto linkage = llvm::Function::ExternalLinkage;
+  std::string name = fn->getName().str() + ".entry";
+  llvm::Function* e = llvm::Function::Create(type, linkage, name, mod);
+
+  ir.SetInsertPoint(llvm::BasicBlock::Create(mod.getContext(), "", e));
+  llvm::Value* err = e->getArg(0);
+  llvm::Value* args = e->getArg(1);
+  std::vector<llvm::Value*> as {err};
+  for (unsigned i = 1; i < fn->arg_size(); ++i) {
+    llvm::Value* p = ir.CreateConstGEP1_32(ix, args, i - 1);
+    as.push_back(ir.CreateLoad(ix, p));
+  }
+  ir.CreateRet(ir.CreateCall(fn, as));
+  return e;
+}
+
+
+// Lower the bytecode of f into the definition of fn.
+void
+Lowering::define(Function_decl const& f, Bytecode& bc, llvm::Function* fn)
+{
+  llvm::LLVMContext& lc = mod.getContext();
+  std::vector<Instruction> const& code = bc.code;
+  llvm::Value* err = fn->getArg(0);
+
+  // Each jump target and each instruction that follows a jump starts
+  // a block.
+  std::vector<llvm::BasicBlock*> blocks(code.size() + 1, nullptr);
+  llvm::BasicBlock* start = llvm::BasicBlock::Create(lc, "", fn);
+  blocks[0] = llvm::BasicBlock::Create(lc, "", fn);
+  for (std::size_t pc = 0; pc < code.size(); ++pc) {
+    Instruction const& i = code[pc];
+    switch (i.op) {
+      case jump_instr:
+        if (!blocks[i.a])
+          blocks[i.a] = llvm::BasicBlock::Create(lc, "", fn);
+        break;
+      case jump_if_instr:
+      case jump_unless_instr:
+        if (!blocks[i.b])
+          blocks[i.b] = llvm::BasicBlock::Create(lc, "", fn);
+        if (!blocks[pc + 1])
+          blocks[pc + 1] = llvm::BasicBlock::Create(lc, "", fn);
+        break;
+      default:
+        break;
+    }
+  }
+
+  // Allocate registers and store the parameters.
+  ir.SetInsertPoint(start);
+  std::vector<llvm::Value*> regs(bc.nregs);
+  for (int n = 0; n < bc.nregs; ++n)
+    regs[n] = ir.CreateAlloca(ix);
+  for (int n = 0; n < bc.nparms; ++n)
+    ir.CreateStore(fn->getArg(n + 1), regs[n]);
+  ir.CreateBr(blocks[0]);
+
+  auto load = [&](int r) { return ir.CreateLoad(ix, regs[r]); };
+  auto store = [&](int r, llvm::Value* v) { ir.CreateStore(v, regs[r]); };
+  auto flag = [&](llvm::Value* v) { return ir.CreateZExt(v, ix); };
+  auto zero = llvm::ConstantInt::get(ix, 0);
+  auto one = llvm::ConstantInt::get(ix, 1);
+  auto minus_one = llvm::ConstantInt::getSigned(ix, -1);
+
+  // Division by zero is an error. Division by -1 is negation so that
+  // overflow wraps, as in the evaluator.
+  auto divide = [&](Instruction const& i, bool rem) {
+    llvm::Value* a = load(i.b);
+    llvm::Value* b = load(i.c);
+    llvm::BasicBlock* bad = llvm::BasicBlock::Create(lc, "", fn);
+    llvm::BasicBlock* ok = llvm::BasicBlock::Create(lc, "", fn);
+    ir.CreateCondBr(ir.CreateICmpEQ(b, zero), bad, ok);
+    ir.SetInsertPoint(bad);
+    fail(err, division_error);
+    ir.SetInsertPoint(ok);
+    llvm::Value* neg = ir.CreateICmpEQ(b, minus_one);
+    llvm::Value* d = ir.CreateSelect(neg, one, b);
+    if (rem)
+      store(i.a, ir.CreateSelect(neg, zero, ir.CreateSRem(a, d)));
+    else
+      store(i.a, ir.CreateSelect(neg, ir.CreateSub(zero, a), ir.CreateSDiv(a, d)));
+  };
+
+  for (std::size_t pc = 0; pc < code.size(); ++pc) {
+    // Start a new block, falling through from the previous one.
+    if (blocks[pc]) {
+      if (!ir.GetInsertBlock()->getTerminator())
+        ir.CreateBr(blocks[pc]);
+      ir.SetInsertPoint(blocks[pc]);
+    }
+
+    // Code after a return or jump is unreachable.
+    if (ir.GetInsertBlock()->getTerminator())
+      continue;
+
+    Instruction const& i = code[pc];
+    switch (i.op) {
+      case const_instr: {
+        Value const& v = bc.consts[i.b];
+        if (!v.is_integer())
+          throw Unsupported();
+        store(i.a, llvm::ConstantInt::getSigned(ix, v.get_integer()));
+        break;
+      }
+      case move_instr:
+        store(i.a, load(i.b));
+        break;
+      case add_instr:
+        store(i.a, ir.CreateAdd(load(i.b), load(i.c)));
+        break;
+      case sub_instr:
+        store(i.a, ir.CreateSub(load(i.b), load(i.c)));
+        break;
+      case mul_instr:
+        store(i.a, ir.CreateMul(load(i.b), load(i.c)));
+        break;
+      case div_instr:
+        divide(i, false);
+        break;
+      case rem_instr:
+        divide(i, true);
+        break;
+      case neg_instr:
+        store(i.a, ir.CreateSub(zero, load(i.b)));
+        break;
+      case eq_instr:
+        store(i.a, flag(ir.CreateICmpEQ(load(i.b), load(i.c))));
+        break;
+      case ne_instr:
+        store(i.a, flag(ir.CreateICmpNE(load(i.b), load(i.c))));
+        break;
+      case lt_instr:
+        store(i.a, flag(ir.CreateICmpSLT(load(i.b), load(i.c))));
+        break;
+      case gt_instr:
+        store(i.a, flag(ir.CreateICmpSGT(load(i.b), load(i.c))));
+        break;
+      case le_instr:
+        store(i.a, flag(ir.CreateICmpSLE(load(i.b), load(i.c))));
+        break;
+      case ge_instr:
+        store(i.a, flag(ir.CreateICmpSGE(load(i.b), load(i.c))));
+        break;
+      case not_instr:
+        store(i.a, flag(ir.CreateICmpEQ(load(i.b), zero)));
+        break;
+      case bool_instr:
+        store(i.a, flag(ir.CreateICmpNE(load(i.b), zero)));
+        break;
+      case jump_instr:
+        ir.CreateBr(blocks[i.a]);
+        break;
+      case jump_if_instr:
+        ir.CreateCondBr(ir.CreateICmpNE(load(i.a), zero), blocks[i.b], blocks[pc + 1]);
+        break;
+      case jump_unless_instr:
+        ir.CreateCondBr(ir.CreateICmpEQ(load(i.a), zero), blocks[i.b], blocks[pc + 1]);
+        break;
+      case call_instr: {
+        Call_site const& site = bc.calls[i.b];
+        llvm::Function* callee = function(*site.fn);
+        if (int(callee->arg_size()) != site.nargs + 1)
+          throw Unsupported();
+        std::vector<llvm::Value*> args {err};
+        for (int n = 0; n < site.nargs; ++n)
+          args.push_back(load(i.c + n));
+        llvm::Value* v = ir.CreateCall(callee, args);
+
+        // Propagate errors from the callee.
+        llvm::BasicBlock* bad = llvm::BasicBlock::Create(lc, "", fn);
+        llvm::BasicBlock* ok = llvm::BasicBlock::Create(lc, "", fn);
+        ir.CreateCondBr(ir.CreateICmpNE(ir.CreateLoad(ix, err), zero), bad, ok);
+        ir.SetInsertPoint(bad);
+        ir.CreateRet(zero);
+        ir.SetInsertPoint(ok);
+        store(i.a, v);
+        break;
+      }
+      case return_instr:
+        ir.CreateRet(load(i.a));
+        break;
+      case fail_instr:
+        fail(err, return_error);
+        break;
+    }
+  }
+
+  // Bytecode always ends with a failure, but be safe.
+  if (!ir.GetInsertBlock()->getTerminator())
+    fail(err, return_error);
+}
+
+
+// Create the JIT. Returns nullptr if the native target is not
+// available.
+std::unique_ptr<Jit_engine>
+make_engine()
+{
+  static bool init = !llvm::InitializeNativeTarget()
+                  && !llvm::InitializeNativeTargetAsmPrinter();
+  if (!init)
+    return nullptr;
+  auto jit = llvm::orc::LLJITBuilder().create();
+  if (!jit) {
+    llvm::consumeError(jit.takeError());
+    return nullptr;
+  }
+  std::unique_ptr<Jit_engine> engine(new Jit_engine());
+  engine->jit = std::move(*jit);
+  return engine;
+}
+
+
+// Compile f and the functions it calls into a new module, returning
+// the entry point of f. Returns nullptr if f cannot be compiled.
+Native_function
+compile_native(Context& cxt, Function_decl const& f)
+{
+  Jit_tier& tier = cxt.jit;
+  if (!tier.engine)
+    tier.engine = make_engine();
+  if (!tier.engine)
+    return nullptr;
+  Jit_engine& engine = *tier.engine;
+
+  auto lc = std::make_unique<llvm::LLVMContext>();
+  std::string id = "banjo." + std::to_string(engine.modules);
+  auto mod = std::make_unique<llvm::Module>(id, *lc);
+  Lowering lower(cxt, engine, *mod);
+  std::string name;
+  try {
+    name = lower.entry(f)->getName().str();
+    while (!lower.work.empty()) {
+      Function_decl const* g = lower.work.back();
+      lower.work.pop_back();
+      lower.define(*g, *get_bytecode(cxt, *g), lower.fns[g]);
+    }
+  } catch (Unsupported&) {
+    return nullptr;
+  }
+  if (llvm::verifyModule(*mod))
+    return nullptr;
+
+  ++engine.modules;
+  llvm::orc::ThreadSafeModule tsm(std::move(mod), std::move(lc));
+  if (auto e = engine.jit->addIRModule(std::move(tsm))) {
+    llvm::consumeError(std::move(e));
+    return nullptr;
+  }
+  auto sym = engine.jit->lookup(name);
+  if (!sym) {
+    llvm::consumeError(sym.takeError());
+    return nullptr;
+  }
+  for (auto const& d : lower.defined)
+    engine.symbols.insert(d);
+  return reinterpret_cast<Native_function>(sym->getAddress());
+}
+
+} // namespace
+
+
+bool
+jit_available()
+{
+  return true;
+}
+
+
+#else
+
+struct Jit_engine { };
+
+
+namespace
+{
+
+Native_function
+compile_native(Context&, Function_decl const&)
+{
+  return nullptr;
+}
+
+} // namespace
+
+
+bool
+jit_available()
+{
+  return false;
+}
+
+#endif
+
+
+// -------------------------------------------------------------------------- //
+// JIT tier
+
+Jit_tier::Jit_tier()
+  : threshold(0), ncompiled(0), nfailed(0), ncalls(0)
+{ }
+
+
+Jit_tier::~Jit_tier()
+{ }
+
+
+// Returns the native code for f, or nullptr if f has not been
+// compiled. Each call counts as an evaluation of f; f is compiled
+// when the count reaches the threshold.
+Native_function
+get_native_function(Context& cxt, Function_decl const& f)
+{
+  Jit_tier& tier = cxt.jit;
+  Native_entry& e = tier.entries[&f];
+  if (e.code)
+    return e.code;
+  if (e.failed || ++e.count < tier.threshold)
+    return nullptr;
+  e.code = compile_native(cxt, f);
+  if (e.code)
+    ++tier.ncompiled;
+  else {
+    e.failed = true;
+    ++tier.nfailed;
+  }
+  return e.code;
+}
+
+
+// Call the native function with the given arguments, which must be
+// integers.
+Value
+call_native(Context& cxt, Native_function f, Value_list const& args)
+{
+  std::vector<std::int64_t> vals;
+  vals.reserve(args.size());
+  for (Value const& v : args)
+    vals.push_back(v.get_integer());
+
+  ++cxt.jit.ncalls;
+  std::int64_t err = no_error;
+  std::int64_t r = f(&err, vals.data());
+  switch (err) {
+    case division_error:
+      throw Evaluation_error("division by zero");
+    case return_error:
+      throw Evaluation_error("function evaluation failed");
+    default:
+      return Integer_value(r);
+  }
+}
+
+
+} // namespace banjo
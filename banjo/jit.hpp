@@ -0,0 +1,96 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_JIT_HPP
+#define BANJO_JIT_HPP
+
+#include "prelude.hpp"
+#include "language.hpp"
+#include "value.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+
+namespace banjo
+{
+
+// -------------------------------------------------------------------------- //
+// Native code
+//
+// Functions that are evaluated frequently can be compiled to native
+// code. The bytecode of a function (see bytecode.hpp) is lowered to
+// LLVM IR and compiled in-process by the ORC JIT. Only functions whose
+// values are integers can be compiled; calls to anything else are
+// evaluated by the interpreter.
+//
+// The JIT is available only when Banjo is built with BANJO_JIT.
+// Otherwise, no function is compiled.
+
+
+// The entry point of a compiled function. The arguments are passed
+// as an array. If evaluation fails, a nonzero error code is stored
+// in the first argument.
+using Native_function = std::int64_t (*)(std::int64_t*, std::int64_t const*);
+
+
+// Error codes produced by native code.
+enum Native_error : std::int64_t
+{
+  no_error,
+  division_error,   // Division by zero
+  return_error,     // The end of a function was reached
+};
+
+
+// The state of native compilation for a function.
+struct Native_entry
+{
+  std::size_t     count;  // The number of evaluations
+  Native_function code;   // The compiled code, if any
+  bool            failed; // True if the function cannot be compiled
+};
+
+
+struct Jit_engine;
+
+
+// Compiles functions whose evaluation count reaches a threshold.
+// The tier is disabled when the threshold is 0, which is the default.
+struct Jit_tier
+{
+  Jit_tier();
+  ~Jit_tier();
+
+  // Returns true if hot functions are compiled.
+  bool enabled() const { return threshold > 0; }
+
+  // Statistics
+  std::size_t compiled() const { return ncompiled; }
+  std::size_t failed() const   { return nfailed; }
+  std::size_t calls() const    { return ncalls; }
+
+  // The number of evaluations of a function before it is compiled.
+  std::size_t threshold;
+
+  std::unordered_map<Function_decl const*, Native_entry> entries;
+
+  // The JIT, which is created on first use.
+  std::unique_ptr<Jit_engine> engine;
+
+  std::size_t ncompiled;
+  std::size_t nfailed;
+  std::size_t ncalls;
+};
+
+
+bool            jit_available();
+Native_function get_native_function(Context&, Function_decl const&);
+Value           call_native(Context&, Native_function, Value_list const&);
+
+
+} // namespace banjo
+
+
+#endif
@@ -0,0 +1,167 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_KIND_HPP
+#define BANJO_KIND_HPP
+
+// This module defines a compact tag for each kind of term. Each
+// hierarchy of terms (and each intermediate base class) occupies a
+// contiguous range of kinds, so testing whether a term is an instance
+// of a class is a pair of integer comparisons, not an RTTI query.
+// See the isa and dyn_cast operations in ast_base.hpp.
+//
+// Terms created by the builder have their kind set when they are
+// allocated. Other terms (e.g., those allocated directly in tests)
+// record the kind returned by Term::term_kind on first use. That
+// function is pure, so every concrete class of terms must name its
+// kind.
+
+#include "prelude.hpp"
+
+
+namespace banjo
+{
+
+struct Term;
+
+
+// The kinds of terms. The order of enumerators determines the
+// ranges below; keep the leaves of each base class adjacent.
+enum Term_kind : unsigned char
+{
+  unknown_kind,
+  translation_unit_kind,
+
+  // Names
+  simple_id_kind,
+  global_id_kind,
+  placeholder_id_kind,
+  operator_id_kind,
+  conversion_id_kind,
+  literal_id_kind,
+  destructor_id_kind,
+  template_id_kind,
+  concept_id_kind,
+  qualified_id_kind,
+
+  // Types
+  void_type_kind,
+  boolean_type_kind,
+  byte_type_kind,
+  integer_type_kind,
+  float_type_kind,
+  auto_type_kind,
+  decltype_type_kind,
+  declauto_type_kind,
+  function_type_kind,
+  qualified_type_kind,
+  pointer_type_kind,
+  reference_type_kind,
+  array_type_kind,
+  sequence_type_kind,
+  class_type_kind,
+  union_type_kind,
+  enum_type_kind,
+  typename_type_kind,
+  synthetic_type_kind,
+
+  // Expressions
+  boolean_expr_kind,
+  integer_expr_kind,
+  real_expr_kind,
+  reference_expr_kind,
+  template_ref_kind,
+  check_expr_kind,
+  neg_expr_kind,
+  pos_expr_kind,
+  not_expr_kind,
+  add_expr_kind,
+  sub_expr_kind,
+  mul_expr_kind,
+  div_expr_kind,
+  rem_expr_kind,
+  eq_expr_kind,
+  ne_expr_kind,
+  lt_expr_kind,
+  gt_expr_kind,
+  le_expr_kind,
+  ge_expr_kind,
+  and_expr_kind,
+  or_expr_kind,
+  assign_expr_kind,
+  call_expr_kind,
+  requires_expr_kind,
+  synthetic_expr_kind,
+  value_conv_kind,
+  qualification_conv_kind,
+  boolean_conv_kind,
+  integer_conv_kind,
+  float_conv_kind,
+  numeric_conv_kind,
+  dependent_conv_kind,
+  ellipsis_conv_kind,
+  trivial_init_kind,
+  copy_init_kind,
+  bind_init_kind,
+  direct_init_kind,
+  aggregate_init_kind,
+
+  // Statements
+  compound_stmt_kind,
+  expression_stmt_kind,
+  declaration_stmt_kind,
+  return_stmt_kind,
+
+  // Declarations
+  variable_decl_kind,
+  constant_decl_kind,
+  object_parm_kind,
+  value_parm_kind,
+  function_decl_kind,
+  class_decl_kind,
+  union_decl_kind,
+  enum_decl_kind,
+  namespace_decl_kind,
+  template_decl_kind,
+  concept_decl_kind,
+  axiom_decl_kind,
+  variadic_parm_kind,
+  type_parm_kind,
+  template_parm_kind,
+
+  // Definitions
+  defaulted_def_kind,
+  deleted_def_kind,
+  expression_def_kind,
+  function_def_kind,
+  class_def_kind,
+  union_def_kind,
+  enum_def_kind,
+  concept_def_kind,
+
+  // Requirements
+  type_req_kind,
+  syntactic_req_kind,
+  semantic_req_kind,
+  expression_req_kind,
+  basic_req_kind,
+  conversion_req_kind,
+  deduction_req_kind,
+
+  // Constraints
+  concept_cons_kind,
+  predicate_cons_kind,
+  expression_cons_kind,
+  type_cons_kind,
+  conversion_cons_kind,
+  deduction_cons_kind,
+  parameterized_cons_kind,
+  conjunction_cons_kind,
+  disjunction_cons_kind,
+};
+
+
+} // namespace banjo
+
+
+#endif
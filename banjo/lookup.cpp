@@ -143,7 +143,7 @@ requirement_lookup(Context& cxt, Expr& e)
   Type_list t1 = get_operand_types(e); // Yuck.
   for (Expr& e2 : s.exprs) {
     // Expressions of different kinds are not comparable.
-    if (typeid(e) != typeid(e2))
+    if (kind_of(e) != kind_of(e2))
       continue;
 
     // Compare the types of operands.
@@ -0,0 +1,73 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_MEMO_HPP
+#define BANJO_MEMO_HPP
+
+#include "prelude.hpp"
+
+#include <boost/functional/hash.hpp>
+
+#include <functional>
+#include <unordered_map>
+
+
+namespace banjo
+{
+
+// A memo table associates the arguments of a computation with its
+// result. Keys are typically (tuples of) pointers to unique terms,
+// so that lookup depends on the identity of terms and not their
+// structure.
+//
+// The table counts the number of successful and failed lookups,
+// which is useful for determining the effectiveness of the cache.
+template<typename K,
+         typename V,
+         typename Hash = boost::hash<K>,
+         typename Eq = std::equal_to<K>>
+struct Memo_table
+{
+  using Map = std::unordered_map<K, V, Hash, Eq>;
+
+  Memo_table()
+    : nhits(0), nmisses(0)
+  { }
+
+  // Returns a pointer to the memoized result for k or nullptr if
+  // there is no such result.
+  V* find(K const& k)
+  {
+    auto iter = map.find(k);
+    if (iter == map.end()) {
+      ++nmisses;
+      return nullptr;
+    }
+    ++nhits;
+    return &iter->second;
+  }
+
+  // Record the result v for k, replacing any previous result.
+  V& insert(K const& k, V const& v)
+  {
+    return map[k] = v;
+  }
+
+  // Discard all memoized results. Statistics are preserved.
+  void clear() { map.clear(); }
+
+  // Statistics
+  std::size_t size() const   { return map.size(); }
+  std::size_t hits() const   { return nhits; }
+  std::size_t misses() const { return nmisses; }
+
+  Map         map;
+  std::size_t nhits;
+  std::size_t nmisses;
+};
+
+
+} // namespace banjo
+
+
+#endif
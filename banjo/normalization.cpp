@@ -64,10 +64,15 @@ normalize_reqs(Context& cxt, Requires_expr& e)
 }
 
 
-// Return the normalized constraint of an expression.
+// Return the normalized constraint of an expression. The result
+// is memoized for each expression, so repeated normalization of
+// e.g., a template's constraints is just a lookup.
 Cons&
 normalize(Context& cxt, Expr& e)
 {
+  if (Cons** p = cxt.normalizations.find(&e))
+    return **p;
+
   struct fn
   {
     Context& cxt;
@@ -77,7 +82,7 @@ normalize(Context& cxt, Expr& e)
     Cons& operator()(Check_expr& e)    { return normalize_check(cxt, e); }
     Cons& operator()(Requires_expr& e) { return normalize_reqs(cxt, e); }
   };
-  return apply(e, fn{cxt});
+  return *cxt.normalizations.insert(&e, &apply(e, fn{cxt}));
 }
 
 
@@ -152,4 +157,17 @@ normalize(Context& cxt, Concept_def& def)
 }
 
 
+// Returns the normal form of the constraints of the template d,
+// which must be constrained. The normal form is stored with the
+// template, so it is computed once.
+Cons&
+normalize(Context& cxt, Template_decl& d)
+{
+  lingo_assert(d.is_constrained());
+  if (!d.is_normalized())
+    d.norm = &normalize(cxt, d.constraint());
+  return d.normalized_constraint();
+}
+
+
 } // namespace banjo
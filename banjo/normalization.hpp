@@ -14,6 +14,7 @@ namespace banjo
 Cons& normalize(Context&, Expr&);
 Cons& normalize(Context&, Req&);
 Cons& normalize(Context&, Concept_def&);
+Cons& normalize(Context&, Template_decl&);
 
 
 } // namespace banjo
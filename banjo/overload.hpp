@@ -13,6 +13,9 @@
 namespace banjo
 {
 
+struct Specialization_order;
+
+
 // Represents a set of overloaded declarations. All declarations have
 // the same name, scope, and kind, but may differ in their different
 // types and constraints.
@@ -25,7 +28,7 @@ struct Overload_set : Decl_list
 
   // Initialize the overload set with a single element.
   Overload_set(Decl& d)
-    : Decl_list {&d}
+    : Decl_list {&d}, order(nullptr)
   { }
 
   // Returns the name of the overloaded declaratin.
@@ -34,7 +37,12 @@ struct Overload_set : Decl_list
 
   // Inserts a new declaration into the overload set. The declaration
   // shall be overloadable with all previous elements of the set.
-  void insert(Decl& d) { push_back(d); }
+  // This invalidates the specialization order of the set.
+  void insert(Decl& d) { push_back(d); order = nullptr; }
+
+  // The partial order of templates in the set, if computed. See
+  // get_specialization_order.
+  Specialization_order* order;
 };
 
 
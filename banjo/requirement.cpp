@@ -48,6 +48,7 @@ make_basic_requirement(Context& cxt, Expr& e, Type& t)
     throw Type_error("expression '{}' declared to have multipe types", e);
 
   e.ty = &t;
+  set_dependence(e);
 
   // Save the declaration of this binding.
   declare_required_expression(cxt, e);
@@ -0,0 +1,354 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "sat.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+
+namespace banjo
+{
+
+namespace
+{
+
+constexpr signed char false_value = 0;
+constexpr signed char true_value  = 1;
+constexpr signed char undef_value = 2;
+
+
+// Returns the internal encoding of the literal x.
+inline int
+encode(int x)
+{
+  return 2 * (std::abs(x) - 1) + (x < 0);
+}
+
+
+// Returns the negation of an internal literal.
+inline int
+negate(int x)
+{
+  return x ^ 1;
+}
+
+
+// Returns the variable index of an internal literal.
+inline int
+variable(int x)
+{
+  return x >> 1;
+}
+
+
+} // namespace
+
+
+Sat_solver::Sat_solver()
+  : head(0), inc(1.0), unsat(false)
+  , ndecisions(0), nconflicts(0), npropagations(0)
+{ }
+
+
+int
+Sat_solver::make_variable()
+{
+  assign.push_back(undef_value);
+  phase.push_back(false_value);
+  level.push_back(0);
+  reason.push_back(-1);
+  activity.push_back(0.0);
+  seen.push_back(0);
+  watches.emplace_back();
+  watches.emplace_back();
+  return int(assign.size());
+}
+
+
+void
+Sat_solver::add_clause(std::initializer_list<int> list)
+{
+  add_clause(std::vector<int>(list));
+}
+
+
+// Add a clause. Clauses are always added at decision level 0, so
+// literals that are already false are removed, and clauses that are
+// already satisfied are discarded. A unit clause is assigned
+// immediately.
+void
+Sat_solver::add_clause(std::vector<int> const& lits)
+{
+  if (unsat)
+    return;
+  backtrack(0);
+
+  Clause c;
+  for (int x : lits) {
+    lingo_assert(x != 0 && std::abs(x) <= variables());
+    int y = encode(x);
+    int v = lit_value(y);
+    if (v == true_value)
+      return;
+    if (v == false_value)
+      continue;
+    if (std::find(c.begin(), c.end(), negate(y)) != c.end())
+      return;
+    if (std::find(c.begin(), c.end(), y) == c.end())
+      c.push_back(y);
+  }
+
+  if (c.empty())
+    unsat = true;
+  else if (c.size() == 1)
+    enqueue(c[0], -1);
+  else
+    store(c);
+}
+
+
+// Returns the value of the literal x in the last satisfying
+// assignment.
+bool
+Sat_solver::value(int x) const
+{
+  int y = encode(x);
+  return (model[variable(y)] ^ (y & 1)) == true_value;
+}
+
+
+// Returns the current value of the internal literal x.
+inline int
+Sat_solver::lit_value(int x) const
+{
+  signed char a = assign[variable(x)];
+  if (a == undef_value)
+    return undef_value;
+  return a ^ (x & 1);
+}
+
+
+// Make the internal literal x true, recording the clause that
+// implied it (or -1 for decisions and units).
+void
+Sat_solver::enqueue(int x, int r)
+{
+  int v = variable(x);
+  assign[v] = (x & 1) ? false_value : true_value;
+  level[v] = decision_level();
+  reason[v] = r;
+  trail.push_back(x);
+}
+
+
+// Add a clause of at least two literals to the database. The first
+// two literals are watched.
+int
+Sat_solver::store(Clause const& c)
+{
+  int n = int(db.size());
+  db.push_back(c);
+  watches[c[0]].push_back(n);
+  watches[c[1]].push_back(n);
+  return n;
+}
+
+
+// Propagate all assignments on the trail. Returns the index of a
+// conflicting clause, or -1 if there is no conflict.
+//
+// For each clause watching a newly false literal, the false literal
+// is moved to the second position. If the first literal is true, the
+// clause is satisfied. Otherwise, we look for a new literal to watch.
+// If there is none, the clause is either unit (its first literal is
+// implied) or conflicting.
+int
+Sat_solver::propagate()
+{
+  int conflict = -1;
+  while (head < trail.size()) {
+    int f = negate(trail[head++]);
+    ++npropagations;
+
+    std::vector<int>& ws = watches[f];
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < ws.size()) {
+      int n = ws[i++];
+      Clause& c = db[n];
+      if (c[0] == f)
+        std::swap(c[0], c[1]);
+
+      if (lit_value(c[0]) == true_value) {
+        ws[j++] = n;
+        continue;
+      }
+
+      bool moved = false;
+      for (std::size_t k = 2; k < c.size(); ++k) {
+        if (lit_value(c[k]) != false_value) {
+          std::swap(c[1], c[k]);
+          watches[c[1]].push_back(n);
+          moved = true;
+          break;
+        }
+      }
+      if (moved)
+        continue;
+
+      ws[j++] = n;
+      if (lit_value(c[0]) == false_value) {
+        conflict = n;
+        head = trail.size();
+        while (i < ws.size())
+          ws[j++] = ws[i++];
+      } else {
+        enqueue(c[0], n);
+      }
+    }
+    ws.resize(j);
+  }
+  return conflict;
+}
+
+
+// Derive a learned clause from the conflicting clause by resolving
+// with the reasons of literals assigned at the current level, until
+// only one such literal (the first UIP) remains. The asserting
+// literal is placed first, and the literal with the highest
+// remaining level second. That level is returned in back.
+void
+Sat_solver::analyze(int conflict, Clause& learnt, int& back)
+{
+  learnt.clear();
+  learnt.push_back(-1);
+
+  int paths = 0;
+  int p = -1;
+  int n = conflict;
+  std::size_t index = trail.size();
+  do {
+    Clause& c = db[n];
+    for (std::size_t k = (p == -1 ? 0 : 1); k < c.size(); ++k) {
+      int q = c[k];
+      int v = variable(q);
+      if (!seen[v] && level[v] > 0) {
+        seen[v] = 1;
+        bump(v);
+        if (level[v] >= decision_level())
+          ++paths;
+        else
+          learnt.push_back(q);
+      }
+    }
+
+    // Select the next literal on the trail to resolve.
+    while (!seen[variable(trail[--index])])
+      ;
+    p = trail[index];
+    n = reason[variable(p)];
+    seen[variable(p)] = 0;
+    --paths;
+  } while (paths > 0);
+  learnt[0] = negate(p);
+
+  back = 0;
+  for (std::size_t k = 1; k < learnt.size(); ++k) {
+    int v = variable(learnt[k]);
+    seen[v] = 0;
+    if (level[v] > back) {
+      back = level[v];
+      std::swap(learnt[1], learnt[k]);
+    }
+  }
+}
+
+
+// Undo all assignments above the given level.
+void
+Sat_solver::backtrack(int l)
+{
+  if (decision_level() <= l)
+    return;
+  for (std::size_t i = trail.size(); i > std::size_t(limits[l]); --i) {
+    int v = variable(trail[i - 1]);
+    phase[v] = assign[v];
+    assign[v] = undef_value;
+    reason[v] = -1;
+  }
+  trail.resize(limits[l]);
+  limits.resize(l);
+  head = trail.size();
+}
+
+
+// Returns the unassigned variable with the highest activity, or -1
+// if all variables are assigned. The problems produced by
+// subsumption are small, so a linear scan is sufficient.
+int
+Sat_solver::pick()
+{
+  int best = -1;
+  for (int v = 0; v < variables(); ++v) {
+    if (assign[v] == undef_value)
+      if (best < 0 || activity[v] > activity[best])
+        best = v;
+  }
+  return best;
+}
+
+
+// Increase the activity of a variable involved in a conflict.
+void
+Sat_solver::bump(int v)
+{
+  activity[v] += inc;
+  if (activity[v] > 1e100) {
+    for (double& a : activity)
+      a *= 1e-100;
+    inc *= 1e-100;
+  }
+}
+
+
+bool
+Sat_solver::solve()
+{
+  if (unsat)
+    return false;
+  backtrack(0);
+
+  Clause learnt;
+  while (true) {
+    int conflict = propagate();
+    if (conflict >= 0) {
+      ++nconflicts;
+      if (decision_level() == 0) {
+        unsat = true;
+        return false;
+      }
+      int back;
+      analyze(conflict, learnt, back);
+      backtrack(back);
+      if (learnt.size() == 1)
+        enqueue(learnt[0], -1);
+      else
+        enqueue(learnt[0], store(learnt));
+      inc /= 0.95;
+    } else {
+      int v = pick();
+      if (v < 0) {
+        model = assign;
+        backtrack(0);
+        return true;
+      }
+      ++ndecisions;
+      limits.push_back(int(trail.size()));
+      enqueue(2 * v + (phase[v] == true_value ? 0 : 1), -1);
+    }
+  }
+}
+
+
+} // namespace banjo
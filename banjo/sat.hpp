@@ -0,0 +1,95 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_SAT_HPP
+#define BANJO_SAT_HPP
+
+#include "prelude.hpp"
+
+#include <initializer_list>
+#include <vector>
+
+
+namespace banjo
+{
+
+// A small conflict-driven clause learning (CDCL) SAT solver. This is
+// used to decide subsumption for constraints whose proofs would
+// otherwise require exponentially many sequents.
+//
+// Variables are numbered from 1. A literal is a non-zero integer;
+// the literal v denotes the variable v, and -v its negation (as in
+// the DIMACS format).
+//
+// The solver uses two watched literals per clause, learns a clause
+// at the first unique implication point of each conflict, and picks
+// decision variables by activity. Clauses may be added between calls
+// to solve(), but the solver is not otherwise incremental.
+struct Sat_solver
+{
+  Sat_solver();
+
+  // Create a new variable, returning its (positive) literal.
+  int make_variable();
+
+  // Add the disjunction of the given literals.
+  void add_clause(std::initializer_list<int>);
+  void add_clause(std::vector<int> const&);
+
+  // Returns true if the clauses are satisfiable. When true, the
+  // satisfying assignment is available via value().
+  bool solve();
+
+  // Returns the value of a literal in the last satisfying assignment.
+  bool value(int) const;
+
+  // Statistics
+  int         variables() const    { return int(assign.size()); }
+  std::size_t clauses() const      { return db.size(); }
+  std::size_t decisions() const    { return ndecisions; }
+  std::size_t conflicts() const    { return nconflicts; }
+  std::size_t propagations() const { return npropagations; }
+
+private:
+  using Clause = std::vector<int>;
+
+  int  lit_value(int) const;
+  int  decision_level() const { return int(limits.size()); }
+  void enqueue(int, int);
+  int  store(Clause const&);
+  int  propagate();
+  void analyze(int, Clause&, int&);
+  void backtrack(int);
+  int  pick();
+  void bump(int);
+
+  // Literals are encoded internally as 2 * (v - 1) + s, where s is 1
+  // for negated literals. The values of variables are 0 (false),
+  // 1 (true) or 2 (unassigned).
+  std::vector<signed char> assign;  // The value of each variable
+  std::vector<signed char> phase;   // The last value of each variable
+  std::vector<signed char> model;   // The last satisfying assignment
+  std::vector<int>         level;   // The decision level of each variable
+  std::vector<int>         reason;  // The implying clause or -1
+  std::vector<double>      activity;
+  std::vector<char>        seen;
+
+  std::vector<Clause>           db;       // Original and learned clauses
+  std::vector<std::vector<int>> watches;  // Clauses watching each literal
+  std::vector<int>              trail;    // Assigned literals, in order
+  std::vector<int>              limits;   // Start of each decision level
+  std::size_t                   head;     // The next literal to propagate
+
+  double inc;   // The current activity increment
+  bool   unsat; // True if a conflict was found at level 0
+
+  std::size_t ndecisions;
+  std::size_t nconflicts;
+  std::size_t npropagations;
+};
+
+
+} // namespace banjo
+
+
+#endif
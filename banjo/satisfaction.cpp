@@ -24,11 +24,12 @@ satisfy_concept(Context& cxt, Concept_cons& c)
 
 
 // A predicate constraint is satisfied if its expression
-// evaluates to true.
+// evaluates to true. The expression is evaluated by the engine
+// selected by the context.
 inline bool
 satisfy_predicate(Context& cxt, Predicate_cons& p)
 {
-  Value v = evaluate(p.expression());
+  Value v = evaluate_constant(cxt, p.expression());
   return v.get_boolean();
 }
 
@@ -55,9 +56,16 @@ satisfy_disjunction(Context& cxt, Disjunction_cons& c)
 
 
 // Determine if a constraint c is satisfied.
+//
+// Constraints are unique, so the result is memoized in the context.
+// In particular, a concept check that guards many declarations is
+// expanded and evaluated only once.
 bool
 is_satisfied(Context& cxt, Cons& c)
 {
+  if (bool* r = cxt.satisfactions.find(&c))
+    return *r;
+
   struct fn
   {
     Context&      cxt;
@@ -67,7 +75,7 @@ is_satisfied(Context& cxt, Cons& c)
     bool operator()(Conjunction_cons& c) { return satisfy_conjunction(cxt, c); }
     bool operator()(Disjunction_cons& c) { return satisfy_disjunction(cxt, c); }
   };
-  return apply(c, fn{cxt});
+  return cxt.satisfactions.insert(&c, apply(c, fn{cxt}));
 }
 
 
@@ -13,12 +13,16 @@
 namespace banjo
 {
 
+struct Admission_index;
+
+
 // -------------------------------------------------------------------------- //
 // Scope definitions
 
 
-// Maps names to overload sets.
-using Name_map = std::unordered_map<Name const*, Overload_set, Name_hash, Name_eq>;
+// Maps names to overload sets. Names are unique within a context
+// (see Builder::get_id), so they are hashed and compared by identity.
+using Name_map = std::unordered_map<Name const*, Overload_set>;
 
 
 // A scope defines a maximal lexical region of text where an
@@ -268,21 +272,29 @@ struct Concept_scope : Scope
 
 // Represents the scope of assumed declarations in a template.
 //
-// This object does not directly contain name bindings.
+// This object does not directly contain name bindings. Instead, it
+// refers to an index of the assumptions in the associated constraints,
+// which is used to determine the admissibility of dependent expressions.
+// See Admission_index in constraint.hpp.
 //
 // TODO: This may ultimately host nested sub-scopes based on
 // a decomposition of constraints.
 struct Constrained_scope : Scope
 {
-  Constrained_scope(Scope& s, Expr& e)
-    : Scope(s), expr(&e)
+  Constrained_scope(Scope& s, Expr& e, Admission_index& ix)
+    : Scope(s), expr(&e), index(&ix)
   { }
 
   // Returns the constraint expression associated with the scope.
   Expr const& associated_constraints() const { return *expr; }
   Expr&       associated_constraints()       { return *expr; }
 
-  Expr* expr;
+  // Returns the index of assumptions in the associated constraints.
+  Admission_index const& admissions() const { return *index; }
+  Admission_index&       admissions()       { return *index; }
+
+  Expr*            expr;
+  Admission_index* index;
 };
 
 
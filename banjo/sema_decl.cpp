@@ -5,6 +5,8 @@
 #include "ast_decl.hpp"
 #include "ast_def.hpp"
 #include "declaration.hpp"
+#include "normalization.hpp"
+#include "instantiation.hpp"
 #include "print.hpp"
 
 #include <iostream>
@@ -27,10 +29,12 @@ Parser::templatize_declaration(Decl& d)
     Template_decl& tmp = build.make_template(*state.template_parms, d);
     state.template_parms = nullptr;
 
-    // Apply constraints, if any.
+    // Apply constraints, if any. The normal form of the constraints
+    // is computed here so that it need not be computed at each use.
     if (state.template_cons) {
       tmp.cons = state.template_cons;
       state.template_cons = nullptr;
+      normalize(cxt, tmp);
     }
     return tmp;
   }
@@ -113,11 +117,15 @@ Parser::on_function_parameter(Name& n, Type& t)
 }
 
 
+// Define the function, and assign slots to its parameters and
+// local variables.
 Def&
 Parser::on_function_definition(Decl& d, Stmt& s)
 {
   Def& def = build.make_function_definition(s);
-  return define_function(d, def);
+  define_function(d, def);
+  allocate_frame(cast<Function_decl>(d.parameterized_declaration()));
+  return def;
 }
 
 
@@ -235,12 +243,14 @@ Parser::on_concept_definition(Decl& decl, Req_list& ds)
 // Translation units
 
 
-// Merge the parsed declarations into the global namespace.
+// Merge the parsed declarations into the global namespace and
+// instantiate the definitions of used specializations.
 Namespace_decl&
 Parser::on_translation_unit(Decl_list& ds)
 {
   Namespace_decl& ns = cxt.global_namespace();
   ns.decls.append(ds.begin(), ds.end());
+  instantiate_pending(cxt);
   return ns;
 }
 
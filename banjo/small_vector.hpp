@@ -0,0 +1,126 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_SMALL_VECTOR_HPP
+#define BANJO_SMALL_VECTOR_HPP
+
+#include "prelude.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+
+namespace banjo
+{
+
+// A vector that stores up to N elements in place, and allocates
+// only when it grows beyond that. Elements must be trivially
+// destructible (e.g., pairs of pointers), so that they can be
+// copied without being constructed or destroyed individually.
+template<typename T, std::size_t N>
+struct Small_vector
+{
+  static_assert(std::is_trivially_destructible<T>::value,
+                "small vector elements must be trivially destructible");
+
+  using value_type     = T;
+  using iterator       = T*;
+  using const_iterator = T const*;
+
+  Small_vector()
+    : first(local), count(0), cap(N)
+  { }
+
+  Small_vector(Small_vector const& x)
+    : Small_vector()
+  {
+    assign(x);
+  }
+
+  Small_vector& operator=(Small_vector const& x)
+  {
+    if (this != &x) {
+      count = 0;
+      assign(x);
+    }
+    return *this;
+  }
+
+  ~Small_vector()
+  {
+    if (first != local)
+      delete[] first;
+  }
+
+  // Returns true if the elements are stored in place.
+  bool is_local() const { return first == local; }
+
+  bool        empty() const { return count == 0; }
+  std::size_t size() const  { return count; }
+
+  T const& operator[](std::size_t n) const { return first[n]; }
+  T&       operator[](std::size_t n)       { return first[n]; }
+
+  const_iterator begin() const { return first; }
+  const_iterator end() const   { return first + count; }
+  iterator       begin()       { return first; }
+  iterator       end()         { return first + count; }
+
+  void push_back(T const& x)
+  {
+    reserve(count + 1);
+    first[count++] = x;
+  }
+
+  // Resize the vector to n elements, filling new elements with x.
+  void resize(std::size_t n, T const& x)
+  {
+    reserve(n);
+    std::fill(first + std::min(n, count), first + n, x);
+    count = n;
+  }
+
+  // Insert n copies of x at the front of the vector.
+  void prepend(std::size_t n, T const& x)
+  {
+    reserve(count + n);
+    std::copy_backward(first, first + count, first + count + n);
+    std::fill(first, first + n, x);
+    count += n;
+  }
+
+  void clear() { count = 0; }
+
+  // Ensure capacity for at least n elements.
+  void reserve(std::size_t n)
+  {
+    if (n <= cap)
+      return;
+    std::size_t c = std::max(n, 2 * cap);
+    T* p = new T[c];
+    std::copy(first, first + count, p);
+    if (first != local)
+      delete[] first;
+    first = p;
+    cap = c;
+  }
+
+private:
+  void assign(Small_vector const& x)
+  {
+    reserve(x.count);
+    std::copy(x.first, x.first + x.count, first);
+    count = x.count;
+  }
+
+  T*          first;
+  std::size_t count;
+  std::size_t cap;
+  T           local[N];
+};
+
+
+} // namespace banjo
+
+
+#endif
@@ -7,6 +7,8 @@
 #include "expression.hpp"
 #include "declaration.hpp"
 #include "equivalence.hpp"
+#include "conversion.hpp"
+#include "initialization.hpp"
 #include "print.hpp"
 
 #include <iostream>
@@ -19,6 +21,77 @@ namespace banjo
 // Substitution class
 
 
+namespace
+{
+
+// Returns the index of the template parameter d in x, or false if
+// d is not a template parameter.
+inline bool
+get_parameter_index(Decl const& d, Index& x)
+{
+  if (Type_parm const* p = dyn_cast<Type_parm>(&d))
+    x = p->index();
+  else if (Value_parm const* p = dyn_cast<Value_parm>(&d))
+    x = p->index();
+  else if (Template_parm const* p = dyn_cast<Template_parm>(&d))
+    x = p->index();
+  else
+    return false;
+  return true;
+}
+
+} // namespace
+
+
+// Returns the entry for d, or nullptr if d is not mapped.
+Substitution::Entry const*
+Substitution::find(Decl const& d) const
+{
+  Index x;
+  if (count != more.size() && get_parameter_index(d, x) && x.depth() == level) {
+    std::size_t n = std::size_t(x.offset() - base);
+    if (n < slots.size() && slots[n].first == &d)
+      return &slots[n];
+  }
+  for (Entry const& e : more)
+    if (e.first == &d)
+      return &e;
+  return nullptr;
+}
+
+
+// Add a mapping for d, which is not already mapped. The slots are
+// extended (in either direction) to cover the offset of d.
+void
+Substitution::insert(Decl& d, Term* t)
+{
+  ++count;
+  Index x;
+  if (get_parameter_index(d, x)) {
+    if (slots.empty()) {
+      level = x.depth();
+      base = x.offset();
+    }
+    if (x.depth() == level) {
+      int n = x.offset() - base;
+      int size = int(slots.size());
+      if (n < 0 && size - n <= max_slots) {
+        slots.prepend(-n, Entry{nullptr, nullptr});
+        base = x.offset();
+        n = 0;
+      } else if (n >= size && n < max_slots) {
+        slots.resize(n + 1, Entry{nullptr, nullptr});
+      }
+      if (0 <= n && n < int(slots.size()) && !slots[n].first) {
+        slots[n] = {&d, t};
+        return;
+      }
+    }
+  }
+  more.push_back({&d, t});
+}
+
+
 // Helper debug output.
 std::ostream&
 operator<<(std::ostream& os, Substitution const& s)
@@ -125,6 +198,10 @@ substitute(Context& cxt, Type& t, Substitution& sub)
     Type& operator()(Sequence_type& t)  { return substitute_type(cxt, t, sub); }
     Type& operator()(Typename_type& t)  { return substitute_type(cxt, t, sub); }
   };
+
+  // A type that contains no parameters is unchanged.
+  if (!t.contains_parameters())
+    return t;
   return apply(t, fn{cxt, sub});
 }
 
@@ -196,16 +273,22 @@ substitute_type(Context& cxt, Typename_type& t, Substitution& sub)
 //
 
 
-// Substitute into a declaration reference. The result of the
-// substitution depends on whether the name refers to a member
-// of the current instantation. If so, then we need to rebind
-// the identfier to the locally instantiated declaration.
-//
-// FIXME: This is almost certainly incorrect.
+// Substitute into a declaration reference. A reference to a
+// value parameter is replaced by its argument. A reference to a
+// declaration that has been substituted (e.g., a parameter or local
+// variable of a function) is rebound to the substituted declaration.
+// Other references are unchanged.
 Expr&
 subst_ref(Context& cxt, Reference_expr& e, Substitution& sub)
 {
-  return make_reference(cxt, e.declaration().name());
+  Decl& d = e.declaration();
+  if (Decl* d1 = sub.get_rebinding(d))
+    return make_reference(cxt, *d1);
+  if (sub.has_mapping(d)) {
+    if (Term* t = sub.get_mapping(d))
+      return cast<Expr>(*t);
+  }
+  return e;
 }
 
 
@@ -231,6 +314,31 @@ subst_call(Context& cxt, Call_expr& e, Substitution& sub)
 }
 
 
+// Substitute into a conversion. The conversion is determined again
+// for the substituted operand and destination type. When those are
+// no longer dependent, it is resolved as a standard conversion.
+Expr&
+subst_conv(Context& cxt, Conv& e, Substitution& sub)
+{
+  Expr& e0 = substitute(cxt, e.source(), sub);
+  Type& t = substitute(cxt, e.type(), sub);
+  if (is_dependent_type(t) || is_type_dependent(e0))
+    return cxt.make<Dependent_conv>(t, e0);
+  return standard_conversion(e0, t);
+}
+
+
+// Substitute into a copy initialization. The initialization is
+// performed again, since the destination type may have changed.
+Expr&
+subst_init(Context& cxt, Copy_init& e, Substitution& sub)
+{
+  Expr& e0 = substitute(cxt, e.expression(), sub);
+  Type& t = substitute(cxt, e.type(), sub);
+  return copy_initialize(cxt, t, e0);
+}
+
+
 template<typename T, typename Make>
 Expr&
 subst_unary(Context& cxt, T& e, Substitution& sub, Make make)
@@ -265,6 +373,8 @@ substitute(Context& cxt, Expr& e, Substitution& sub)
     Expr& operator()(Reference_expr& e) { return subst_ref(cxt, e, sub); }
     Expr& operator()(Check_expr& e)     { return subst_check(cxt, e, sub); }
     Expr& operator()(Call_expr& e)      { return subst_call(cxt, e, sub); }
+    Expr& operator()(Conv& e)           { return subst_conv(cxt, e, sub); }
+    Expr& operator()(Copy_init& e)      { return subst_init(cxt, e, sub); }
 
     Expr& operator()(Eq_expr& e)  { return subst_binary(cxt, e, sub, make_eq); }
     Expr& operator()(Ne_expr& e)  { return subst_binary(cxt, e, sub, make_ne); }
@@ -277,6 +387,11 @@ substitute(Context& cxt, Expr& e, Substitution& sub)
     Expr& operator()(Not_expr& e) { return subst_unary(cxt, e, sub, make_logical_not); }
 
   };
+
+  // An expression that contains no parameters, and does not refer
+  // to objects that must be rebound, is unchanged.
+  if (!e.contains_parameters())
+    return e;
   return apply(e, fn{cxt, sub});
 }
 
@@ -289,6 +404,10 @@ substitute(Context& cxt, Expr& e, Substitution& sub)
 // special form of substitution where we generate a newly named
 // declaration.
 //
+// Each substituted declaration is recorded in the substitution, so
+// that later references to the original declaration are rebound to
+// the new one (see subst_ref).
+//
 // FIXME: Substitution is kind of like parsing. We need to interpret
 // the resulting constructs as if they were parsed. That means we
 // need to maintain binding environments to support lookup and
@@ -300,9 +419,16 @@ substitute_decl(Context& cxt, Variable_decl& d, Substitution& sub)
 {
   Name& n = d.name();
   Type& t = substitute(cxt, d.type(), sub);
-  Decl& var = cxt.make_variable(n, t);
-  declare(cxt, var);
-  return var;
+  Variable_decl* var;
+  if (d.has_initializer()) {
+    Expr& e = substitute(cxt, d.initializer(), sub);
+    var = &cxt.make_variable(n, t, e);
+  } else {
+    var = &cxt.make_variable(n, t);
+  }
+  declare(cxt, *var);
+  sub.rebind(d, *var);
+  return *var;
 }
 
 
@@ -315,6 +441,7 @@ substitute_decl(Context& cxt, Object_parm& d, Substitution& sub)
   Type& t = substitute(cxt, d.type(), sub);
   Decl& parm = cxt.make_object_parm(n, t);
   declare(cxt, parm);
+  sub.rebind(d, parm);
   return parm;
 }
 
@@ -356,6 +483,7 @@ subst_usage(Context& cxt, Expression_cons& c, Substitution& sub)
 
   // Ensure that e has type t: that's what's been assumed.
   e.ty = &t;
+  set_dependence(e);
 
   return cxt.get_expression_constraint(e, t);
 }
@@ -421,4 +549,92 @@ substitute(Context& cxt, Cons& c, Substitution& sub)
 }
 
 
+// -------------------------------------------------------------------------- //
+// Substitution into statements
+//
+// Statements are substituted when instantiating the definition of
+// a function template specialization. Declarations in the resulting
+// statements are declared in new block scopes, and references in
+// later statements are rebound to them.
+
+Stmt&
+subst_compound(Context& cxt, Compound_stmt& s, Substitution& sub)
+{
+  Enter_scope scope(cxt, cxt.make_block_scope());
+  Stmt_list ss;
+  for (Stmt& s1 : s.statements())
+    ss.push_back(substitute(cxt, s1, sub));
+  return cxt.make_compound_statement(ss);
+}
+
+
+Stmt&
+subst_expression(Context& cxt, Expression_stmt& s, Substitution& sub)
+{
+  Expr& e = substitute(cxt, s.expression(), sub);
+  return cxt.make_expression_statement(e);
+}
+
+
+Stmt&
+subst_declaration(Context& cxt, Declaration_stmt& s, Substitution& sub)
+{
+  Decl& d = substitute(cxt, s.declaration(), sub);
+  return cxt.make_declaration_statement(d);
+}
+
+
+Stmt&
+subst_return(Context& cxt, Return_stmt& s, Substitution& sub)
+{
+  Expr& e = substitute(cxt, s.expression(), sub);
+  return cxt.make_return_statement(e);
+}
+
+
+Stmt&
+substitute(Context& cxt, Stmt& s, Substitution& sub)
+{
+  struct fn
+  {
+    Context&      cxt;
+    Substitution& sub;
+    Stmt& operator()(Stmt const& s)             { banjo_unhandled_case(s); }
+    Stmt& operator()(Compound_stmt const& s)    { return subst_compound(cxt, modify(s), sub); }
+    Stmt& operator()(Expression_stmt const& s)  { return subst_expression(cxt, modify(s), sub); }
+    Stmt& operator()(Declaration_stmt const& s) { return subst_declaration(cxt, modify(s), sub); }
+    Stmt& operator()(Return_stmt const& s)      { return subst_return(cxt, modify(s), sub); }
+  };
+  return apply(s, fn{cxt, sub});
+}
+
+
+// -------------------------------------------------------------------------- //
+// Substitution into definitions
+
+Def&
+substitute(Context& cxt, Def& d, Substitution& sub)
+{
+  struct fn
+  {
+    Context&      cxt;
+    Substitution& sub;
+    Def& operator()(Def& d)           { banjo_unhandled_case(d); }
+    Def& operator()(Defaulted_def& d) { return d; }
+    Def& operator()(Deleted_def& d)   { return d; }
+
+    Def& operator()(Expression_def& d)
+    {
+      return cxt.make_expression_definition(substitute(cxt, d.expression(), sub));
+    }
+
+    Def& operator()(Function_def& d)
+    {
+      return cxt.make_function_definition(substitute(cxt, d.statement(), sub));
+    }
+  };
+  return apply(d, fn{cxt, sub});
+}
+
+
 } // namespace banjo
@@ -6,6 +6,10 @@
 
 #include "prelude.hpp"
 #include "language.hpp"
+#include "small_vector.hpp"
+
+#include <iterator>
+#include <vector>
 
 
 namespace banjo
@@ -20,10 +24,32 @@ namespace banjo
 // This mapping is general. We assume that the kind and type of
 // arguments match their corresponding declarations.
 //
-// Note that declarations are guaranteed to be unique, so we can
-// hash on identity rather than syntax.
-struct Substitution : std::unordered_map<Decl*, Term*>
+// Mappings are addressed by parameter index rather than hashed. The
+// parameters of a single template share a depth and have consecutive
+// offsets, so their mappings are stored in a flat array of slots
+// indexed by offset. The first few slots are stored in place, so
+// substitutions for small templates do not allocate. A slot records
+// the declaration it maps, and lookup checks that identity, so
+// parameters with the same index (e.g., from different scopes)
+// cannot be confused. Mappings that do not fit the slots (other
+// depths, unindexed declarations, collisions) are kept in a short
+// overflow list that is searched linearly.
+//
+// Iterating over a substitution yields (parameter, argument) pairs,
+// with slotted parameters ordered by index.
+//
+// Declarations produced by substituting into a pattern are recorded
+// separately, so that references to the pattern's declarations can
+// be rebound to them (see rebind).
+struct Substitution
 {
+  using Entry = std::pair<Decl*, Term*>;
+  using Rebinding = std::pair<Decl const*, Decl*>;
+  using value_type = Entry;
+
+  class const_iterator;
+  using iterator = const_iterator;
+
   Substitution();
   Substitution(Decl_list&);
   Substitution(Decl_list&, Term_list&);
@@ -40,6 +66,11 @@ struct Substitution : std::unordered_map<Decl*, Term*>
   // Returns true if there is a mapping for this parameter.
   bool has_mapping(Decl&) const;
 
+  // Record that d was substituted to produce d1. References to d
+  // in later substitutions are rebound to d1.
+  void  rebind(Decl& d, Decl& d1);
+  Decl* get_rebinding(Decl const& d) const;
+
   // Returns true if the mapping is incomplete (i.e., has declarations)
   // not mapped to values.
   bool is_incomplete() const;
@@ -47,6 +78,12 @@ struct Substitution : std::unordered_map<Decl*, Term*>
   Decl_list parameters() const;
   Term_list arguments() const;
 
+  bool        empty() const { return count == 0; }
+  std::size_t size() const  { return count; }
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
   // Contextually convert to true whe the substitution is valid.
   explicit operator bool() const { return ok; }
 
@@ -54,13 +91,96 @@ struct Substitution : std::unordered_map<Decl*, Term*>
   void fail() { ok = false; }
 
   bool ok; // Used to invalidate a substitution.
+
+private:
+  // The maximum number of slots. Parameters further than this from
+  // the first slotted parameter are stored in the overflow list.
+  static constexpr int max_slots = 64;
+
+  Entry const* find(Decl const&) const;
+  Entry*       find(Decl const&);
+  void         insert(Decl&, Term*);
+
+  Small_vector<Entry, 4> slots; // Mappings indexed by offset
+  std::vector<Entry>     more;  // Overflow mappings
+  std::vector<Rebinding> decls; // Substituted declarations
+  int                    level; // The depth of slotted parameters
+  int                    base;  // The offset of the first slot
+  std::size_t            count; // The number of mappings
+};
+
+
+// Iterates over the mappings of a substitution, skipping empty
+// slots.
+class Substitution::const_iterator
+{
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type        = Entry;
+  using difference_type   = std::ptrdiff_t;
+  using pointer           = Entry const*;
+  using reference         = Entry const&;
+
+  const_iterator()
+    : sub(nullptr), pos(0)
+  { }
+
+  const_iterator(Substitution const& s, std::size_t n)
+    : sub(&s), pos(n)
+  {
+    skip();
+  }
+
+  reference operator*() const  { return *get(); }
+  pointer   operator->() const { return get(); }
+
+  const_iterator& operator++()
+  {
+    ++pos;
+    skip();
+    return *this;
+  }
+
+  const_iterator operator++(int)
+  {
+    const_iterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  friend bool operator==(const_iterator const& a, const_iterator const& b)
+  {
+    return a.pos == b.pos;
+  }
+
+  friend bool operator!=(const_iterator const& a, const_iterator const& b)
+  {
+    return a.pos != b.pos;
+  }
+
+private:
+  // Positions past the slots refer to the overflow list.
+  pointer get() const
+  {
+    std::size_t n = sub->slots.size();
+    return pos < n ? &sub->slots[pos] : &sub->more[pos - n];
+  }
+
+  void skip()
+  {
+    while (pos < sub->slots.size() && !sub->slots[pos].first)
+      ++pos;
+  }
+
+  Substitution const* sub;
+  std::size_t         pos;
 };
 
 
 // Initialize an empty substitution.
 inline
 Substitution::Substitution()
-  : ok(true)
+  : ok(true), level(-1), base(0), count(0)
 { }
 
 
@@ -68,9 +188,10 @@ Substitution::Substitution()
 // to parameters. Initially map each parameter to a null pointer.
 inline
 Substitution::Substitution(Decl_list& p)
+  : Substitution()
 {
   for (Decl& d : p)
-    insert({&d, nullptr});
+    seed_with(d);
 }
 
 
@@ -78,7 +199,7 @@ Substitution::Substitution(Decl_list& p)
 // `pi` in `p` to its corresponding `ai` in `a`.
 inline
 Substitution::Substitution(Decl_list& p, Term_list& a)
-  : ok(true)
+  : Substitution()
 {
   auto pi = p.begin();
   auto ai = a.begin();
@@ -90,13 +211,21 @@ Substitution::Substitution(Decl_list& p, Term_list& a)
 }
 
 
+inline Substitution::Entry*
+Substitution::find(Decl const& d)
+{
+  return const_cast<Entry*>(static_cast<Substitution const&>(*this).find(d));
+}
+
+
 // Insert an unmapped declaration into the set.
 //
 // TODO: Verify that any prior seeding is unmapped.
 inline void
 Substitution::seed_with(Decl& d)
 {
-  emplace(&d, nullptr);
+  if (!find(d))
+    insert(d, nullptr);
 }
 
 
@@ -107,12 +236,11 @@ Substitution::seed_with(Decl& d)
 inline void
 Substitution::map_to(Decl& d, Term& t)
 {
-  auto iter = find(&d);
-  if (iter == end()) {
-    emplace(&d, &t);
+  if (Entry* e = find(d)) {
+    lingo_assert(!e->second);
+    e->second = &t;
   } else {
-    lingo_assert(!iter->second);
-    iter->second = &t;
+    insert(d, &t);
   }
 }
 
@@ -120,7 +248,30 @@ Substitution::map_to(Decl& d, Term& t)
 inline bool
 Substitution::has_mapping(Decl& d) const
 {
-  return count(&d) != 0;
+  return find(d) != nullptr;
+}
+
+
+// Rebinding does not create a mapping, so it does not affect the
+// parameters or arguments of the substitution. A declaration may be
+// rebound more than once (e.g., when a pattern is substituted into
+// repeatedly); the most recent rebinding is used.
+inline void
+Substitution::rebind(Decl& d, Decl& d1)
+{
+  decls.push_back({&d, &d1});
+}
+
+
+// Returns the declaration to which d has been rebound, or nullptr
+// if d has not been substituted.
+inline Decl*
+Substitution::get_rebinding(Decl const& d) const
+{
+  for (auto iter = decls.rbegin(); iter != decls.rend(); ++iter)
+    if (iter->first == &d)
+      return iter->second;
+  return nullptr;
 }
 
 
@@ -137,14 +288,14 @@ Substitution::is_incomplete() const
 inline Term const*
 Substitution::get_mapping(Decl& d) const
 {
-  return find(&d)->second;
+  return find(d)->second;
 }
 
 
 inline Term*
 Substitution::get_mapping(Decl& d)
 {
-  return find(&d)->second;
+  return find(d)->second;
 }
 
 
@@ -170,6 +321,20 @@ Substitution::arguments() const
 }
 
 
+inline Substitution::const_iterator
+Substitution::begin() const
+{
+  return const_iterator(*this, 0);
+}
+
+
+inline Substitution::const_iterator
+Substitution::end() const
+{
+  return const_iterator(*this, slots.size() + more.size());
+}
+
+
 std::ostream& operator<<(std::ostream&, Substitution const&);
 
 
@@ -183,6 +348,8 @@ Type& substitute(Context&, Type&, Substitution&);
 Expr& substitute(Context&, Expr&, Substitution&);
 Decl& substitute(Context&, Decl&, Substitution&);
 Cons& substitute(Context&, Cons&, Substitution&);
+Stmt& substitute(Context&, Stmt&, Substitution&);
+Def&  substitute(Context&, Def&, Substitution&);
 
 
 } // namespace banjo
@@ -9,9 +9,11 @@
 #include "substitution.hpp"
 #include "hash.hpp"
 #include "print.hpp"
+#include "sat.hpp"
+#include "id_set.hpp"
 
 #include <list>
-#include <unordered_set>
+#include <vector>
 #include <iostream>
 
 
@@ -22,64 +24,89 @@ namespace banjo
 // -------------------------------------------------------------------------- //
 // Proof structures
 
-// A list of propositions (constraints). These are accumulated on either
-// side of a sequent. This is actually a list equipped with a side-table
-// to optimize list membership.
+// A set of propositions, identified by their unique ids. Constraints
+// are unique, so two constraints are equivalent exactly when they
+// have the same id.
 //
-// FIXME: An unordered map on constraint *values* will be inefficient.
-// We really want to work on constraint identities, which means we
-// need to canonicalize constraints.
-struct Prop_list
+// The set is a bit vector over ids, so membership is a bit test, and
+// comparing the antecedents and consequents of a sequent is a word
+// at a time. Copying a set is a memcpy.
+struct Prop_set
 {
-  using Seq            = std::list<Cons const*>;
-  using iterator       = Seq::iterator;
-  using const_iterator = Seq::const_iterator;
+  Prop_set()
+    : count(0)
+  { }
 
-  using Map = std::unordered_map<Cons const*, iterator, Cons_hash, Cons_eq>;
+  // Returns true if c is in the set.
+  bool contains(Cons const* c) const
+  {
+    return ids.contains(c->unique_id());
+  }
 
+  // Insert c into the set. Returns false if c was already present.
+  bool insert(Cons const* c)
+  {
+    if (!ids.insert(c->unique_id()))
+      return false;
+    ++count;
+    return true;
+  }
 
-  // Returns true if the list has a constraint that is identical
-  // to c.
-  bool contains(Cons const& c) const
+  // Remove c from the set, if present.
+  void erase(Cons const* c)
   {
-    return map.count(&c) != 0;
+    if (ids.erase(c->unique_id()))
+      --count;
   }
 
-  // Insert a new constraint. No action is taken if the constraint
-  // is already in the set. Returns the index of the added
-  // constraint or that of the original constraint.
-  std::pair<iterator, bool> insert(Cons const& c)
+  // Returns true if this set and s have a proposition in common.
+  bool intersects(Prop_set const& s) const
   {
-    auto iter = map.find(&c);
-    if (iter != map.end()) {
-      return {iter->second, false};
-    } else {
-      auto pos = seq.insert(seq.end(), &c);
-      map.emplace(&c, pos);
-      return {pos, true};
-    }
+    return ids.intersects(s.ids);
   }
 
-  // Positionally insert the constraint before pos. This does nothing if
-  // c is in the map, returing the same iterator.
-  std::pair<iterator, bool> insert(iterator pos, Cons const& c)
+  std::size_t size() const { return count; }
+
+private:
+  Id_set      ids;
+  std::size_t count; // The number of elements
+};
+
+
+// A list of propositions (constraints). These are accumulated on either
+// side of a sequent. This is a vector equipped with a set of the same
+// constraints to optimize list membership.
+//
+// Propositions are compared by identity, which is valid because
+// constraints are unique. Both the vector and the set are flat, so
+// copying a list (e.g., when branching a proof) does not allocate
+// a node per proposition.
+//
+// Operations that modify the list return an iterator to the position
+// at which work should continue. Iterators are invalidated by those
+// operations.
+struct Prop_list
+{
+  using Seq            = std::vector<Cons const*>;
+  using iterator       = Seq::iterator;
+  using const_iterator = Seq::const_iterator;
+
+  // Returns true if the list has a constraint that is identical
+  // to c.
+  bool contains(Cons const& c) const
   {
-    auto iter = map.find(&c);
-    if (iter != map.end()) {
-      return {pos, false};
-    } else {
-      pos = seq.insert(pos, &c);
-      map.emplace(&c, pos);
-      return {pos, true};
-    }
+    return set.contains(&c);
   }
 
-  // Erase the constraint from the list. This nulls the entry in the
-  // sequence, so it must be replaced.
-  iterator erase(iterator pos)
+  // Insert a new constraint at the end of the list. No action is taken
+  // if the constraint is already in the set. Returns the position of
+  // the added constraint or end().
+  std::pair<iterator, bool> insert(Cons const& c)
   {
-    map.erase(*pos);
-    return seq.erase(pos);
+    if (!set.insert(&c))
+      return {seq.end(), false};
+    seq.push_back(&c);
+    return {seq.end() - 1, true};
   }
 
   // Replace the term in the list with c. Note that no replacement
@@ -91,11 +118,12 @@ struct Prop_list
   // iterator past the original replaced element.
   std::pair<iterator, bool> replace(iterator pos, Cons const& c)
   {
-    pos = erase(pos);
-    auto x = insert(pos, c);
-    if (x.second)
-      return x;
-    return {pos, false};
+    set.erase(*pos);
+    if (set.insert(&c)) {
+      *pos = &c;
+      return {cur = pos, true};
+    }
+    return {cur = seq.erase(pos), false};
   }
 
   // Replace the term in the list with c1 folowed by c2. Note that
@@ -107,14 +135,22 @@ struct Prop_list
   // i is the iterator past the original replaced element.
   std::pair<iterator, bool> replace(iterator pos, Cons const& c1, Cons const& c2)
   {
-    pos = erase(pos);
-    auto x1 = insert(pos, c1);
-    auto x2 = insert(pos, c2);
-    if (x1.second)
-      return x1;
-    if (x2.second)
-      return x2;
-    return {pos, false};
+    std::size_t n = pos - seq.begin();
+    set.erase(*pos);
+    bool b1 = set.insert(&c1);
+    bool b2 = set.insert(&c2);
+    if (b1 && b2) {
+      seq[n] = &c1;
+      seq.insert(seq.begin() + n + 1, &c2);
+    } else if (b1) {
+      seq[n] = &c1;
+    } else if (b2) {
+      seq[n] = &c2;
+    } else {
+      seq.erase(seq.begin() + n);
+      return {cur = seq.begin() + n, false};
+    }
+    return {cur = seq.begin() + n, true};
   }
 
   // Iterators
@@ -128,7 +164,7 @@ struct Prop_list
   const_iterator begin() const { return seq.begin(); }
   const_iterator end()   const { return seq.end(); }
 
-  Map      map;
+  Prop_set set;
   Seq      seq;
   iterator cur;
 };
@@ -317,12 +353,35 @@ is_reduced(Prop_list const& ps)
 
 // -------------------------------------------------------------------------- //
 // Subsumption memoization
+//
+// The result of each subsumption query is recorded in the context,
+// keyed on the identities of the antecedent and consequent. Both
+// positive and negative results are recorded. Because constraints
+// are unique, repeated queries find the same entry.
+
+// Returns a pointer to the memoized result of A |- C, or nullptr
+// if the query has not been answered.
+inline bool const*
+find_memoized(Context& cxt, Cons const& a, Cons const& c)
+{
+  return cxt.subsumptions.find({&a, &c});
+}
 
-// TODO: Memoize the subsumption relation.
+
+// Returns true if A is known to subsume C.
 bool
-is_memoized(Context& cxt, Cons const& a, Cons const& b)
+is_memoized(Context& cxt, Cons const& a, Cons const& c)
 {
-  return false;
+  bool const* r = find_memoized(cxt, a, c);
+  return r && *r;
+}
+
+
+// Record the result of A |- C, and return that result.
+inline bool
+memoize(Context& cxt, Cons const& a, Cons const& c, bool r)
+{
+  return cxt.subsumptions.insert({&a, &c}, r);
 }
 
 
@@ -523,6 +582,11 @@ validate(Context& cxt, Sequent& s)
   Prop_list& as = s.antecedents();
   Prop_list& cs = s.consequents();
 
+  // If any Ci is (syntactically) among the antecedents, the proof
+  // is valid.
+  if (as.set.intersects(cs.set))
+    return valid_proof;
+
   Validation r = invalid_proof;
   for (Cons const* c : cs) {
     Validation v = validate(cxt, as, *c);
@@ -548,11 +612,9 @@ validate(Proof& p)
   auto iter = goals.begin();
   while (iter != goals.end()) {
     Validation v = validate(cxt, *iter);
-    if (v == valid_proof)
-      iter = goals.discharge(iter);
-    else if (v == invalid_proof || v == incomplete_proof)
+    if (v != valid_proof)
       return v;
-    ++iter;
+    iter = goals.discharge(iter);
   }
   if (goals.empty())
     return valid_proof;
@@ -735,9 +797,11 @@ flatten_right(Proof p, Sequent& s)
 void
 flatten(Proof p)
 {
-  for (Sequent& s : p.goals()) {
-    flatten_left(p, s);
-    flatten_right(p, s);
+  Goal_list& goals = p.goals();
+  for (auto iter = goals.begin(); iter != goals.end(); ++iter) {
+    Proof q(p.context(), goals, iter);
+    flatten_left(q, *iter);
+    flatten_right(q, *iter);
   }
 }
 
@@ -801,8 +865,15 @@ expand_left(Proof& p, Sequent& s)
   auto best = std::min_element(ps.begin(), ps.end(), is_better_expansion);
   if (Concept_cons const* c = as<Concept_cons>(*best))
     ps.replace(best, expand(p.context(), *c));
-  else if (Disjunction_cons const* d = as<Disjunction_cons>(*best))
-    ps.replace(best, d->left(), d->right());
+  else if (Disjunction_cons const* d = as<Disjunction_cons>(*best)) {
+    // Each operand of the disjunction is a separate case. The
+    // right operand is moved into a new goal.
+    std::size_t n = best - ps.begin();
+    Proof q = p.branch();
+    Prop_list& qs = q.antecedents();
+    qs.replace(qs.begin() + n, d->right());
+    ps.replace(best, d->left());
+  }
 }
 
 
@@ -831,36 +902,127 @@ expand_right(Proof& p, Sequent& s)
 //
 // TODO: There are other interesting strategies. For example,
 // we might choose to expand all concepts first.
+//
+// Goals created by branching are not expanded until the next step.
 void
 expand(Proof p)
 {
-  for (Sequent& s : p.goals()) {
-    expand_left(p, s);
-    // expand_right(p, s);
+  Goal_list& goals = p.goals();
+  auto iter = goals.begin();
+  for (std::size_t n = goals.size(); n != 0; --n, ++iter) {
+    Proof q(p.context(), goals, iter);
+    expand_left(q, *iter);
+    // expand_right(q, *iter);
   }
 }
 
 
+// -------------------------------------------------------------------------- //
+// Propositional subsumption
+//
+// A subsumes C exactly when A & !C is unsatisfiable, where atomic
+// constraints are treated as propositional variables. Concepts are
+// expanded, and parameterized constraints are transparent (as in
+// the sequent prover). Conjunctions and disjunctions are encoded
+// using the Tseitin transformation, so the size of the formula is
+// linear in the size of the (expanded) constraints.
+
+
+// Maps constraints to the literals that represent them. Unique
+// constraints are encoded once, no matter how often they occur.
+// Literals are indexed by the unique id of the constraint; 0 means
+// the constraint has not been encoded.
+struct Encoding
+{
+  Context&         cxt;
+  Sat_solver&      sat;
+  std::vector<int> lits;
+};
+
+
+int encode(Encoding&, Cons const&);
+
+
+// Returns a literal x such that x <=> (a & b).
+int
+encode_conjunction(Encoding& e, Binary_cons const& c)
+{
+  int a = encode(e, c.left());
+  int b = encode(e, c.right());
+  int x = e.sat.make_variable();
+  e.sat.add_clause({-x, a});
+  e.sat.add_clause({-x, b});
+  e.sat.add_clause({x, -a, -b});
+  return x;
+}
+
+
+// Returns a literal x such that x <=> (a | b).
+int
+encode_disjunction(Encoding& e, Binary_cons const& c)
+{
+  int a = encode(e, c.left());
+  int b = encode(e, c.right());
+  int x = e.sat.make_variable();
+  e.sat.add_clause({-x, a, b});
+  e.sat.add_clause({x, -a});
+  e.sat.add_clause({x, -b});
+  return x;
+}
+
+
+// Returns the literal representing c.
+int
+encode(Encoding& e, Cons const& c)
+{
+  struct fn
+  {
+    Encoding& e;
+    int operator()(Cons const& c)               { return e.sat.make_variable(); }
+    int operator()(Concept_cons const& c)       { return encode(e, expand(e.cxt, c)); }
+    int operator()(Parameterized_cons const& c) { return encode(e, c.constraint()); }
+    int operator()(Conjunction_cons const& c)   { return encode_conjunction(e, c); }
+    int operator()(Disjunction_cons const& c)   { return encode_disjunction(e, c); }
+  };
+
+  lingo_assert(c.unique_id() >= 0);
+  std::size_t n = c.unique_id();
+  if (n < e.lits.size() && e.lits[n])
+    return e.lits[n];
+  int x = apply(c, fn{e});
+  if (n >= e.lits.size())
+    e.lits.resize(n + 1, 0);
+  e.lits[n] = x;
+  return x;
+}
+
+
+// Prove or disprove that a subsumes c using the SAT solver.
+bool
+prove_sat(Context& cxt, Cons const& a, Cons const& c)
+{
+  Sat_solver sat;
+  Encoding e {cxt, sat, {}};
+  sat.add_clause({encode(e, a)});
+  sat.add_clause({-encode(e, c)});
+  return !sat.solve();
+}
+
+
 // -------------------------------------------------------------------------- //
 // Subsumption
 
 
-// Returns true if a subsumes c.
+// Prove or disprove that a subsumes c by constructing a proof
+// in the sequent calculus.
 //
 // TODO: How do I know when I've exhuasted all opportunities.
 bool
-subsumes(Context& cxt, Cons const& a, Cons const& c)
+prove_sequent(Context& cxt, Cons const& a, Cons const& c)
 {
-  // Check the easy cases before setting up a proof.
-  if (is_equivalent(a, c))
-    return true;
-  if (is_memoized(cxt, a, c))
-    return true;
-
-  // Alas... no quick check. We have to prove the implication.
   Goal_list goals(Sequent(a, c));
   Proof p(cxt, goals);
-  std::cout << "INIT: " << p.sequent() << '\n';
+  // std::cout << "INIT: " << p.sequent() << '\n';
 
   // Continue manipulating the proof state until we know that
   // the implication is valid or not.
@@ -869,8 +1031,8 @@ subsumes(Context& cxt, Cons const& a, Cons const& c)
   do {
     // Opportunistically flatten sequents in each goal.
     flatten(p);
-    std::cout << "------------\n";
-    std::cout << "STEP " << n << ": " << p.sequent() << '\n';
+    // std::cout << "------------\n";
+    // std::cout << "STEP " << n << ": " << p.sequent() << '\n';
 
     // Having done that, determine if the proof is valid (or not).
     // In either case, we can stop.
@@ -898,6 +1060,27 @@ subsumes(Context& cxt, Cons const& a, Cons const& c)
 }
 
 
+// Returns true if a subsumes c. The result is memoized. The proof
+// is constructed by the context's subsumption engine.
+bool
+subsumes(Context& cxt, Cons const& a, Cons const& c)
+{
+  // Check the easy cases before setting up a proof.
+  if (is_equivalent(a, c))
+    return true;
+  if (bool const* r = find_memoized(cxt, a, c))
+    return *r;
+
+  // Alas... no quick check. We have to prove the implication.
+  bool r;
+  if (cxt.prover == sat_engine)
+    r = prove_sat(cxt, a, c);
+  else
+    r = prove_sequent(cxt, a, c);
+  return memoize(cxt, a, c, r);
+}
+
+
 bool
 subsumes(Context& cxt, Expr const& a, Expr const& c)
 {
@@ -11,6 +11,23 @@
 namespace banjo
 {
 
+// The algorithms used to decide subsumption.
+//
+// The sequent engine searches for a syntactic proof of the
+// implication. It is fast for constraints that are mostly
+// conjunctions, but the number of subgoals can grow exponentially
+// with the number of disjunctions.
+//
+// The SAT engine encodes the negation of the implication as a
+// propositional formula over atomic constraints, and checks that
+// it is unsatisfiable.
+enum Subsumption_engine
+{
+  sequent_engine,
+  sat_engine,
+};
+
+
 bool subsumes(Context&, Cons const&, Cons const&);
 bool subsumes(Context&, Expr const&, Expr const&);
 
@@ -9,6 +9,9 @@
 #include "deduction.hpp"
 #include "print.hpp"
 #include "builder.hpp"
+#include "hash.hpp"
+#include "equivalence.hpp"
+#include "evaluation.hpp"
 
 #include <iostream>
 
@@ -43,14 +46,20 @@ initialize_type_template_parameter(Context& cxt, Type_parm& p, Term& a)
 }
 
 
-// TODO: Is there anything else to do here? Perhaps verify that
-// the argument is also a constant expressions!
+// The argument is converted to the type of the parameter. Unless it
+// is value-dependent, it is reduced to its value, so that equivalent
+// arguments name the same specialization.
+//
+// TODO: Verify that the argument is a constant expression.
 Expr&
 initialize_value_template_parameter(Context& cxt, Value_parm& p, Term& a)
 {
   if (!is<Expr>(&a))
     throw std::runtime_error("argument is not a value");
-  return copy_initialize(cxt, p.type(), cast<Expr>(a));
+  Expr& e = copy_initialize(cxt, p.type(), cast<Expr>(a));
+  if (is_value_dependent(e))
+    return e;
+  return reduce(cxt, e);
 }
 
 
@@ -121,6 +130,20 @@ initialize_template_parameters(Context& cxt, Decl_list& parms, Term_list& args)
 // -------------------------------------------------------------------------- //
 // Template specialization
 
+std::size_t
+Template_args_hash::operator()(Term_list const& args) const
+{
+  return hash_value(args);
+}
+
+
+bool
+Template_args_eq::operator()(Term_list const& a, Term_list const& b) const
+{
+  return is_equivalent(a, b);
+}
+
+
 // TODO: This is basically what happens for every single declaration.
 // Find a way of generalizing it.
 Decl&
@@ -177,6 +200,10 @@ specialize_class(Context& cxt, Template_decl& tmp, Class_decl& d, Substitution&
 // initializer. That is done only when the the definition is actually
 // needed for use.
 //
+// Each specialization is recorded in the template's table of
+// specializations, so that later requests for a specialization with
+// equivalent arguments yield the same declaration.
+//
 // TODO: Finish implementing this.
 Decl&
 specialize_declaration(Context& cxt, Template_decl& tmp, Decl& decl, Substitution& sub)
@@ -198,10 +225,22 @@ specialize_declaration(Context& cxt, Template_decl& tmp, Decl& decl, Substitutio
   // TODO: We can build the specialization name for all templates
   // here and push that down down into the more specific algorithms.
 
-  // TODO: Search for an existing specialization of the template
-  // having the equivalent template arguments.
-
-  return apply(decl, fn{cxt, tmp, sub});
+  // Search for an existing specialization of the template having
+  // equivalent template arguments. Arguments are listed in the order
+  // of the template parameters.
+  Term_list args;
+  for (Decl& p : tmp.parameters()) {
+    lingo_assert(sub.has_mapping(p) && sub.get_mapping(p));
+    args.push_back(sub.get_mapping(p));
+  }
+  Specialization_table& specs = tmp.specializations();
+  if (Decl** spec = specs.find(args))
+    return **spec;
+
+  Decl& spec = apply(decl, fn{cxt, tmp, sub});
+  specs.insert(args, &spec);
+  cxt.instantiations.record(tmp, spec, args);
+  return spec;
 }
 
 
@@ -209,7 +248,8 @@ specialize_declaration(Context& cxt, Template_decl& tmp, Decl& decl, Substitutio
 // `d`, given a list of template arguments.
 //
 // Note that this only builds the declaration. It does not fully
-// instantiate the definition.
+// instantiate the definition. See require_definition() and
+// instantiate_definition() in instantiation.hpp.
 Decl&
 specialize_template(Context& cxt, Template_decl& tmp, Term_list& args)
 {
@@ -356,12 +396,15 @@ transform_type_for_ordering(Type& t)
 }
 
 
+namespace
+{
+
 // Returns true if tmpl1 is at least as specialized as tmpl2. This
 // is the case when template argument duduction, using the transformed
 // type of tmpl1 succeeds type of tmpl2. Adjustments are made depending
 // on cvontext.
 bool
-is_at_least_as_specialized(Context& cxt, Template_decl& tmp1, Template_decl& tmp2)
+deduce_for_ordering(Context& cxt, Template_decl& tmp1, Template_decl& tmp2)
 {
   Function_decl& f1 = cast<Function_decl>(tmp1.parameterized_declaration());
   Function_decl& f2 = cast<Function_decl>(tmp2.parameterized_declaration());
@@ -390,6 +433,24 @@ is_at_least_as_specialized(Context& cxt, Template_decl& tmp1, Template_decl& tmp
   return true;
 }
 
+} // namespace
+
+
+// Returns true if tmpl1 is at least as specialized as tmpl2.
+//
+// Ordering synthesizes arguments and performs deduction, so the
+// result is memoized for each pair of templates.
+bool
+is_at_least_as_specialized(Context& cxt, Template_decl& tmp1, Template_decl& tmp2)
+{
+  auto key = std::make_pair(&tmp1, &tmp2);
+  if (bool const* prev = cxt.orderings.find(key))
+    return *prev;
+  bool result = deduce_for_ordering(cxt, tmp1, tmp2);
+  cxt.orderings.insert(key, result);
+  return result;
+}
+
 
 
 // Determine whether tmp1 is more specialized than tmp2, or vice
@@ -409,4 +470,113 @@ is_more_specialized(Context& cxt, Template_decl& tmp1, Template_decl& tmp2)
      && !is_at_least_as_specialized(cxt, tmp2, tmp1);
 }
 
+
+// -------------------------------------------------------------------------- //
+// Specialization order of overload sets
+
+// Returns the candidate that is more specialized than every other
+// candidate, or nullptr if there is no such candidate.
+Decl*
+Specialization_order::most_specialized(Id_set const& cands) const
+{
+  Decl* result = nullptr;
+  cands.for_each([&](int i) {
+    if (result)
+      return;
+    Id_set rest = cands;
+    rest.erase(i);
+    if (rest.is_subset_of(more[i]))
+      result = decls[i];
+  });
+  return result;
+}
+
+
+namespace
+{
+
+// Returns the function template declared by d, or nullptr if d
+// does not declare a function template.
+inline Template_decl*
+get_function_template(Decl& d)
+{
+  if (Template_decl* t = as<Template_decl>(&d))
+    if (is<Function_decl>(&t->parameterized_declaration()))
+      return t;
+  return nullptr;
+}
+
+
+// Returns true if the function templates t1 and t2 can be ordered.
+// Ordering deduces each function parameter of one template from the
+// corresponding parameter of the other, so both must have the same
+// number of parameters.
+inline bool
+is_comparable(Template_decl& t1, Template_decl& t2)
+{
+  Function_decl& f1 = cast<Function_decl>(t1.parameterized_declaration());
+  Function_decl& f2 = cast<Function_decl>(t2.parameterized_declaration());
+  return f1.parameters().size() == f2.parameters().size();
+}
+
+} // namespace
+
+
+// Returns the specialization order of the overload set, computing
+// it if needed. Only function templates with the same number of
+// parameters are ordered; every other pair of declarations is
+// unordered.
+Specialization_order&
+get_specialization_order(Context& cxt, Overload_set& ovl)
+{
+  if (ovl.order)
+    return *ovl.order;
+
+  Specialization_order& ord = cxt.arena.make<Specialization_order>();
+  for (Decl& d : ovl) {
+    ord.pos.emplace(&d, int(ord.decls.size()));
+    ord.decls.push_back(&d);
+  }
+  ord.more.resize(ord.decls.size());
+
+  int n = int(ord.decls.size());
+  for (int i = 0; i < n; ++i) {
+    Template_decl* t1 = get_function_template(*ord.decls[i]);
+    if (!t1)
+      continue;
+    for (int j = i + 1; j < n; ++j) {
+      Template_decl* t2 = get_function_template(*ord.decls[j]);
+      if (!t2 || !is_comparable(*t1, *t2))
+        continue;
+      bool a = is_at_least_as_specialized(cxt, *t1, *t2);
+      bool b = is_at_least_as_specialized(cxt, *t2, *t1);
+      if (a && !b)
+        ord.more[i].insert(j);
+      else if (b && !a)
+        ord.more[j].insert(i);
+    }
+  }
+
+  ovl.order = &ord;
+  return ord;
+}
+
+
+// Returns the most specialized of the candidates, which are members
+// of the overload set, or nullptr if no candidate is more specialized
+// than all others.
+Decl*
+most_specialized(Context& cxt, Overload_set& ovl, Decl_list& cands)
+{
+  Specialization_order& ord = get_specialization_order(cxt, ovl);
+  Id_set ids;
+  for (Decl& d : cands) {
+    int n = ord.position(d);
+    lingo_assert(n >= 0);
+    ids.insert(n);
+  }
+  return ord.most_specialized(ids);
+}
+
+
 } // namespace banjo
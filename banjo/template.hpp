@@ -7,6 +7,11 @@
 #include "prelude.hpp"
 #include "language.hpp"
 #include "substitution.hpp"
+#include "overload.hpp"
+#include "id_set.hpp"
+
+#include <unordered_map>
+#include <vector>
 
 
 namespace banjo
@@ -33,10 +38,39 @@ enum Partial_ordering
 };
 
 
+bool is_at_least_as_specialized(Context&, Template_decl&, Template_decl&);
 bool is_more_specialized(Context&, Template_decl&, Template_decl&);
 bool is_more_constrained(Context&, Template_decl&, Template_decl&);
 
 
+// The partial order, by specialization, of the function templates
+// in an overload set. Declarations are numbered by their position
+// in the set, and more[i] is the set of declarations that i is more
+// specialized than. The order is computed once per overload set
+// (see get_specialization_order), so selecting the most specialized
+// of a set of candidates requires no further deduction.
+struct Specialization_order
+{
+  // Returns the position of d in the overload set, or -1 if d
+  // is not in the set.
+  int position(Decl const& d) const
+  {
+    auto iter = pos.find(&d);
+    return iter != pos.end() ? iter->second : -1;
+  }
+
+  Decl* most_specialized(Id_set const&) const;
+
+  std::vector<Decl*>                   decls;
+  std::vector<Id_set>                  more;
+  std::unordered_map<Decl const*, int> pos;
+};
+
+
+Specialization_order& get_specialization_order(Context&, Overload_set&);
+Decl*                 most_specialized(Context&, Overload_set&, Decl_list&);
+
+
 } // namespace banjo
 
 
@@ -0,0 +1,121 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "test.hpp"
+
+#include <banjo/substitution.hpp>
+#include <banjo/print.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+
+// Measures the cost of dispatching through apply() by substituting
+// into and printing a large, synthetic set of terms. Build once
+// normally and once with the BANJO_VIRTUAL_DISPATCH option to
+// compare kind-based dispatch against the virtual visitors:
+//
+//    bench_apply [size] [repetitions]
+//
+// The size determines the number of types and the depth of the
+// expression trees.
+
+
+using Clock = std::chrono::steady_clock;
+
+
+// Returns a type of roughly n nodes that depends on the type t.
+Type&
+make_type(Builder& build, Type& t, int n)
+{
+  Type* r = &t;
+  for (int i = 0; i < n; ++i) {
+    switch (i % 4) {
+      case 0: r = &build.get_pointer_type(*r); break;
+      case 1: r = &build.get_const_type(*r); break;
+      case 2: r = &build.get_reference_type(*r); break;
+      case 3: r = &build.get_function_type(Type_list{r, &t}, t); break;
+    }
+  }
+  return *r;
+}
+
+
+// Returns a balanced expression tree of the given depth. The leaves
+// are integer literals.
+Expr&
+make_expr(Builder& build, int depth)
+{
+  if (depth == 0)
+    return build.get_int(depth);
+  Type& b = build.get_bool_type();
+  Expr& l = make_expr(build, depth - 1);
+  Expr& r = make_expr(build, depth - 1);
+  if (depth == 1)
+    return build.make_eq(b, l, r);
+  return build.make_and(b, l, r);
+}
+
+
+// Returns the mean time in milliseconds of reps calls to f.
+template<typename F>
+double
+measure(int reps, F f)
+{
+  auto start = Clock::now();
+  for (int i = 0; i < reps; ++i)
+    f();
+  auto stop = Clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count() / reps;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  int n = argc > 1 ? std::atoi(argv[1]) : 1000;
+  int reps = argc > 2 ? std::atoi(argv[2]) : 10;
+
+  Context cxt;
+  Builder build(cxt);
+
+  Decl& parm = build.make_type_parameter("T");
+  Type& t = build.get_typename_type(parm);
+  Substitution sub;
+  sub.map_to(parm, build.get_int_type());
+
+  std::vector<Type*> types;
+  for (int i = 0; i < n; ++i)
+    types.push_back(&make_type(build, t, 16 + i % 16));
+
+  int depth = 1;
+  while ((1 << depth) < n)
+    ++depth;
+  Expr& expr = make_expr(build, depth);
+
+  double subst = measure(reps, [&]() {
+    for (Type* p : types)
+      substitute(cxt, *p, sub);
+    substitute(cxt, expr, sub);
+  });
+
+  double print = measure(reps, [&]() {
+    std::stringstream ss;
+    Printer p(ss);
+    for (Type* p1 : types)
+      p(*p1);
+    p(expr);
+  });
+
+#ifdef BANJO_VIRTUAL_DISPATCH
+  std::cout << "dispatch:    visitor\n";
+#else
+  std::cout << "dispatch:    kind\n";
+#endif
+  std::cout << "types:       " << types.size() << '\n';
+  std::cout << "expr depth:  " << depth << '\n';
+  std::cout << "substitute:  " << subst << " ms\n";
+  std::cout << "print:       " << print << " ms\n";
+}
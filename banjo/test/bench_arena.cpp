@@ -0,0 +1,115 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "test.hpp"
+
+#include <banjo/context.hpp>
+#include <banjo/lexer.hpp>
+#include <banjo/parser.hpp>
+
+#include <lingo/file.hpp>
+#include <lingo/io.hpp>
+#include <lingo/error.hpp>
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+
+// Measures the cost of parsing and elaborating a large, generated
+// translation unit. Build once normally and once with the
+// BANJO_HEAP_ALLOCATION option to compare the arena against plain
+// heap allocation:
+//
+//    bench_arena [functions] [repetitions]
+//
+// Each repetition uses a fresh context, so the arena is torn down
+// and rebuilt every time. Peak RSS is reported for the whole process.
+
+
+using Clock = std::chrono::steady_clock;
+
+
+// Write a translation unit with n groups of declarations.
+void
+generate(char const* path, int n)
+{
+  std::ofstream os(path);
+  os << "concept Eq<typename T>\n"
+     << "{\n"
+     << "  requires (T a, T b) {\n"
+     << "    a == b : bool;\n"
+     << "    a != b : bool;\n"
+     << "  }\n"
+     << "}\n\n";
+  for (int i = 0; i < n; ++i) {
+    os << "var int v" << i << " = " << i << ";\n"
+       << "def f" << i << "(int a, int b) -> bool { return a < b; }\n"
+       << "template<typename T>\n"
+       << "  requires Eq<T>\n"
+       << "def g" << i << "(T const x, T y) -> bool { x == y && true; }\n\n";
+  }
+}
+
+
+// Peak resident set size in kilobytes.
+long
+peak_rss()
+{
+  rusage r;
+  getrusage(RUSAGE_SELF, &r);
+  return r.ru_maxrss;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  int n = argc > 1 ? std::atoi(argv[1]) : 2000;
+  int reps = argc > 2 ? std::atoi(argv[2]) : 5;
+
+  char const* path = "bench_arena.banjo";
+  generate(path, n);
+
+  double total = 0;
+  std::size_t objects = 0;
+  std::size_t bytes = 0;
+  for (int i = 0; i < reps; ++i) {
+    Context cxt;
+    File input(path);
+    Character_stream cs(input);
+    Token_stream ts(input);
+    Lexer lex(cxt, cs, ts);
+    Parser parse(cxt, ts);
+
+    auto start = Clock::now();
+    try {
+      lex();
+      parse();
+    } catch (Compiler_error& err) {
+      std::cerr << err.what();
+      return 1;
+    }
+    auto stop = Clock::now();
+    if (error_count())
+      return 1;
+
+    total += std::chrono::duration<double, std::milli>(stop - start).count();
+    objects = cxt.arena.objects();
+    bytes = cxt.arena.allocated();
+  }
+
+#ifdef BANJO_HEAP_ALLOCATION
+  std::cout << "allocator:  heap\n";
+#else
+  std::cout << "allocator:  arena\n";
+#endif
+  std::cout << "functions:  " << n << '\n';
+  std::cout << "objects:    " << objects << '\n';
+  std::cout << "bytes:      " << bytes << '\n';
+  std::cout << "mean time:  " << total / reps << " ms\n";
+  std::cout << "peak rss:   " << peak_rss() << " KB\n";
+}
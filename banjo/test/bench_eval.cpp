@@ -0,0 +1,118 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "test.hpp"
+
+#include <banjo/evaluation.hpp>
+#include <banjo/bytecode.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+
+
+// Compares the evaluator, compiled code, and iterative evaluation on
+// recursive functions:
+//
+//    bench_eval [depth] [fib]
+//
+// The functions are
+//
+//    down(n) = n == 0 || down(n - 1)
+//    fib(n)  = n < 2 || fib(n - 1) && fib(n - 2)
+//
+// The first measures the cost of a deep chain of calls, the second
+// the cost of many shallow calls.
+
+
+using Clock = std::chrono::steady_clock;
+
+
+// Define f to return the expression e.
+void
+define(Builder& build, Function_decl& f, Expr& e)
+{
+  Stmt& ret = build.make_return_statement(e);
+  f.def = &build.make_function_definition(build.make_compound_statement({&ret}));
+}
+
+
+Function_decl&
+make_down(Builder& build)
+{
+  Type& z = build.get_int_type();
+  Type& b = build.get_bool_type();
+  Object_parm& n = build.make_object_parm("n", z);
+  Function_decl& f = build.make_function("down", {&n}, b);
+  Expr& rn = build.make_reference(n);
+  Expr& n1 = build.make_sub(z, rn, build.get_int(1));
+  define(build, f,
+    build.make_or(b,
+      build.make_eq(b, rn, build.get_int(0)),
+      build.make_call(b, f, {&n1})));
+  return f;
+}
+
+
+Function_decl&
+make_fib(Builder& build)
+{
+  Type& z = build.get_int_type();
+  Type& b = build.get_bool_type();
+  Object_parm& n = build.make_object_parm("n", z);
+  Function_decl& f = build.make_function("fib", {&n}, b);
+  Expr& rn = build.make_reference(n);
+  Expr& n1 = build.make_sub(z, rn, build.get_int(1));
+  Expr& n2 = build.make_sub(z, rn, build.get_int(2));
+  define(build, f,
+    build.make_or(b,
+      build.make_lt(b, rn, build.get_int(2)),
+      build.make_and(b, build.make_call(b, f, {&n1}),
+                        build.make_call(b, f, {&n2}))));
+  return f;
+}
+
+
+void
+run(char const* name, Context& cxt, Expr& e, std::function<Value(Context&, Expr&)> eval)
+{
+  auto start = Clock::now();
+  Value v = eval(cxt, e);
+  auto stop = Clock::now();
+
+  double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+  std::cout << "  " << name << ": " << ms << " ms (" << v.get_integer() << ")\n";
+}
+
+
+void
+compare(char const* name, Context& cxt, Expr& e)
+{
+  std::cout << name << ":\n";
+  run("evaluator", cxt, e, [](Context& c, Expr& e) { return evaluate(c, e); });
+  run("bytecode ", cxt, e, [](Context& c, Expr& e) { return execute(c, e); });
+  run("iterative", cxt, e, [](Context& c, Expr& e) { return evaluate_iteratively(c, e); });
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  int depth = argc > 1 ? std::atoi(argv[1]) : 10000;
+  int fib = argc > 2 ? std::atoi(argv[2]) : 24;
+  if (depth < 0 || fib < 0) {
+    std::cerr << "usage: bench_eval [depth] [fib]\n";
+    return 1;
+  }
+
+  Context cxt;
+  Builder build(cxt);
+  Type& b = build.get_bool_type();
+
+  Function_decl& down = make_down(build);
+  compare("down", cxt, build.make_call(b, down, {&build.get_int(depth)}));
+
+  Function_decl& f = make_fib(build);
+  compare("fib", cxt, build.make_call(b, f, {&build.get_int(fib)}));
+}
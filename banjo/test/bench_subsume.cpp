@@ -0,0 +1,117 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "test.hpp"
+
+#include <banjo/normalization.hpp>
+#include <banjo/subsumption.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+
+// Compares the subsumption engines on a generated hierarchy of
+// concepts:
+//
+//    bench_subsume [width] [depth]
+//
+// Level 0 has width concepts, each defined by a distinct atomic
+// constraint. Each concept at level k is defined in terms of three
+// concepts at level k - 1:
+//
+//    C(k, i) = (C(k-1, i) || C(k-1, i+1)) && C(k-1, i+2)
+//
+// Every concept at the top level is compared against every concept
+// at the previous level. Deep hierarchies with many disjunctions
+// tend to exceed the limits of the sequent engine.
+
+
+using Clock = std::chrono::steady_clock;
+
+
+// Builds the hierarchy, returning the concepts at each level.
+std::vector<std::vector<Concept_decl*>>
+make_hierarchy(Context& cxt, int width, int depth)
+{
+  Builder build(cxt);
+  Type& b = build.get_bool_type();
+
+  std::vector<std::vector<Concept_decl*>> levels(depth + 1);
+  for (int i = 0; i < width + 2 * depth; ++i) {
+    Type_parm& p = build.make_type_parameter("T");
+    std::string n = "C_0_" + std::to_string(i);
+    levels[0].push_back(&build.make_concept(n.c_str(), {&p}, build.get_int(i)));
+  }
+  for (int k = 1; k <= depth; ++k) {
+    std::vector<Concept_decl*>& prev = levels[k - 1];
+    for (std::size_t i = 0; i + 2 < prev.size(); ++i) {
+      Type_parm& p = build.make_type_parameter("T");
+      Type& t = build.get_typename_type(p);
+      Expr& c1 = build.make_check(*prev[i], {&t});
+      Expr& c2 = build.make_check(*prev[i + 1], {&t});
+      Expr& c3 = build.make_check(*prev[i + 2], {&t});
+      Expr& e = build.make_and(b, build.make_or(b, c1, c2), c3);
+      std::string n = "C_" + std::to_string(k) + "_" + std::to_string(i);
+      levels[k].push_back(&build.make_concept(n.c_str(), {&p}, e));
+    }
+  }
+  return levels;
+}
+
+
+void
+run(char const* name, Subsumption_engine engine, int width, int depth)
+{
+  Context cxt;
+  Builder build(cxt);
+  cxt.prover = engine;
+
+  auto levels = make_hierarchy(cxt, width, depth);
+  Type_parm& p = build.make_type_parameter("U");
+  Type& u = build.get_typename_type(p);
+  auto constrain = [&](Concept_decl& c) -> Cons& {
+    return normalize(cxt, build.make_check(c, {&u}));
+  };
+
+  int queries = 0;
+  int proved = 0;
+  int limits = 0;
+  auto start = Clock::now();
+  for (Concept_decl* a : levels[depth]) {
+    for (Concept_decl* c : levels[depth - 1]) {
+      ++queries;
+      try {
+        if (subsumes(cxt, constrain(*a), constrain(*c)))
+          ++proved;
+      } catch (Limitation_error&) {
+        ++limits;
+      }
+    }
+  }
+  auto stop = Clock::now();
+
+  double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+  std::cout << name << ":\n";
+  std::cout << "  queries:   " << queries << '\n';
+  std::cout << "  proved:    " << proved << '\n';
+  std::cout << "  limits:    " << limits << '\n';
+  std::cout << "  time:      " << ms << " ms\n";
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  int width = argc > 1 ? std::atoi(argv[1]) : 8;
+  int depth = argc > 2 ? std::atoi(argv[2]) : 4;
+  if (width < 1 || depth < 1) {
+    std::cerr << "usage: bench_subsume [width] [depth]\n";
+    return 1;
+  }
+
+  std::cout << "width: " << width << ", depth: " << depth << '\n';
+  run("sequent", sequent_engine, width, depth);
+  run("sat", sat_engine, width, depth);
+}
@@ -5,6 +5,9 @@
 
 #include <banjo/normalization.hpp>
 #include <banjo/subsumption.hpp>
+#include <banjo/constraint.hpp>
+#include <banjo/satisfaction.hpp>
+#include <banjo/id_set.hpp>
 
 #include <iostream>
 
@@ -45,6 +48,206 @@ test_canonical(Context& cxt)
 }
 
 
+// Normal forms are memoized for each expression, and stored with
+// constrained templates.
+void
+test_normalize(Context& cxt)
+{
+  Builder build(cxt);
+
+  Type& b = build.get_bool_type();
+  Expr& e = build.make_and(b, build.get_true(), build.get_false());
+
+  Cons& c = normalize(cxt, e);
+  std::size_t hits = cxt.normalizations.hits();
+  assert(&normalize(cxt, e) == &c);
+  assert(cxt.normalizations.hits() == hits + 1);
+
+  Type_parm& p = build.make_type_parameter("T");
+  Decl& f = build.make_function("f", {}, b);
+  Template_decl& t = build.make_template({&p}, f);
+  t.constrain(e);
+  assert(!t.is_normalized());
+  assert(&normalize(cxt, t) == &c);
+  assert(t.is_normalized());
+}
+
+
+// Each concept constraint is expanded once.
+void
+test_expand(Context& cxt)
+{
+  Builder build(cxt);
+
+  Concept_decl& c = make_concept_1(cxt);
+  Type& t = build.get_int_type();
+  Concept_cons& c1 = build.get_concept_constraint(c, {&t});
+  Concept_cons& c2 = build.get_concept_constraint(c, {&t});
+  assert(&c1 == &c2);
+
+  std::size_t hits = cxt.expansions.hits();
+  Cons& e1 = expand(cxt, c1);
+  Cons& e2 = expand(cxt, c2);
+  assert(&e1 == &e2);
+  assert(cxt.expansions.hits() == hits + 1);
+}
+
+
+// Satisfaction of a concept check is determined once.
+void
+test_satisfy(Context& cxt)
+{
+  Builder build(cxt);
+
+  Concept_decl& c = make_concept_1(cxt);
+  Type& t = build.get_int_type();
+  Concept_cons& c1 = build.get_concept_constraint(c, {&t});
+
+  std::size_t hits = cxt.satisfactions.hits();
+  assert(is_satisfied(cxt, c1));
+  assert(is_satisfied(cxt, c1));
+  assert(cxt.satisfactions.hits() == hits + 1);
+}
+
+
+// Returns the function down(n) = n == 0 || down(n - 1).
+Function_decl&
+make_down(Context& cxt)
+{
+  Builder build(cxt);
+  Type& z = build.get_int_type();
+  Type& b = build.get_bool_type();
+
+  Object_parm& n = build.make_object_parm("n", z);
+  Function_decl& down = build.make_function("down", {&n}, b);
+  Expr& rn = build.make_reference(n);
+  Expr& n1 = build.make_sub(z, rn, build.get_int(1));
+  Stmt& ret = build.make_return_statement(
+    build.make_or(b,
+      build.make_eq(b, rn, build.get_int(0)),
+      build.make_call(b, down, {&n1})));
+  down.def = &build.make_function_definition(build.make_compound_statement({&ret}));
+  return down;
+}
+
+
+// Predicates are evaluated by the engine selected by the context.
+// Exceeding a limit of the iterative engine is an evaluation error.
+void
+test_satisfy_limit(Context& cxt)
+{
+  Builder build(cxt);
+  Type& b = build.get_bool_type();
+  Function_decl& down = make_down(cxt);
+
+  Expr& deep = build.make_call(b, down, {&build.get_int(100000)});
+  Expr& shallow = build.make_call(b, down, {&build.get_int(10)});
+  Cons& c1 = build.get_predicate_constraint(deep);
+  Cons& c2 = build.get_predicate_constraint(shallow);
+
+  cxt.evaluation.engine = iterative_engine;
+  cxt.evaluation.depth_limit = 1000;
+  bool err = false;
+  try { is_satisfied(cxt, c1); } catch (Evaluation_error&) { err = true; }
+  assert(err);
+  assert(is_satisfied(cxt, c2));
+
+  // The failed evaluation is not memoized.
+  cxt.evaluation.depth_limit = 1 << 18;
+  assert(is_satisfied(cxt, c1));
+  cxt.evaluation = Evaluation_mode();
+}
+
+
+// When the compiled engine is selected, predicates are evaluated
+// by executing compiled code.
+void
+test_satisfy_compiled(Context& cxt)
+{
+  Builder build(cxt);
+  Type& b = build.get_bool_type();
+  Function_decl& down = make_down(cxt);
+
+  Cons& c = build.get_predicate_constraint(build.make_call(b, down, {&build.get_int(10)}));
+  cxt.evaluation.engine = compiled_engine;
+  assert(is_satisfied(cxt, c));
+  assert(cxt.bytecode.map.count(&down) && cxt.bytecode.map[&down]);
+  cxt.evaluation = Evaluation_mode();
+}
+
+
+// Unique constraints are numbered densely, and sets of constraints
+// can be compared by id.
+void
+test_unique_ids(Context& cxt)
+{
+  Builder build(cxt);
+
+  Cons& c1 = build.get_predicate_constraint(build.get_int(10));
+  Cons& c2 = build.get_predicate_constraint(build.get_int(11));
+  Cons& c3 = build.get_conjunction_constraint(c1, c2);
+  assert(c1.unique_id() >= 0);
+  assert(c2.unique_id() == c1.unique_id() + 1);
+  assert(c3.unique_id() == c2.unique_id() + 1);
+  assert(&build.get_conjunction_constraint(c1, c2) == &c3);
+  assert(cxt.constraints.size() == std::size_t(c3.unique_id() + 1));
+  assert(cxt.constraints[c3.unique_id()] == &c3);
+
+  Id_set s1;
+  Id_set s2;
+  s1.insert(c1.unique_id());
+  s2.insert(c1.unique_id());
+  s2.insert(c3.unique_id());
+  s2.insert(200);
+  assert(s1.is_subset_of(s2));
+  assert(!s2.is_subset_of(s1));
+  assert(s1.intersects(s2));
+  assert((s1 | s2) == s2);
+  assert((s1 & s2) == s1);
+  assert(s2.size() == 3);
+  s2.erase(200);
+  s2.erase(c1.unique_id());
+  assert(!s1.intersects(s2));
+  assert(s2.size() == 1 && s2.contains(c3.unique_id()));
+}
+
+
+// Usage constraints are indexed by the kind of the required
+// expression. Disjunctions are not flattened.
+void
+test_admission_index(Context& cxt)
+{
+  Builder build(cxt);
+
+  Type& b = build.get_bool_type();
+  Expr& z = build.get_int(0);
+  Cons& p = build.get_predicate_constraint(build.get_true());
+  Cons& e1 = build.get_expression_constraint(build.make_eq(b, z, z), b);
+  Cons& e2 = build.get_conversion_constraint(build.make_lt(b, z, z), b);
+  Cons& e3 = build.get_expression_constraint(build.make_eq(b, z, build.get_int(1)), b);
+  Cons& d = build.get_disjunction_constraint(e2, e3);
+  Cons& c = build.get_conjunction_constraint(p,
+              build.get_conjunction_constraint(e1,
+                build.get_conjunction_constraint(d, e2)));
+
+  Admission_index& ix = make_admission_index(cxt, c);
+  assert(&make_admission_index(cxt, c) == &ix);
+  assert(ix.size == 3);
+  assert(ix.rest.size() == 1 && ix.rest[0].cons == &d);
+
+  auto const* eqs = ix.expressions(eq_expr_kind);
+  assert(eqs && eqs->size() == 1 && (*eqs)[0].cons == &e1);
+  assert(!ix.conversions(eq_expr_kind));
+
+  auto const* lts = ix.conversions(lt_expr_kind);
+  assert(lts && lts->size() == 1 && (*lts)[0].cons == &e2);
+  assert((*lts)[0].pos == 2);
+  assert(ix.expressions(lt_expr_kind)->size() == 1);
+
+  assert(!ix.expressions(add_expr_kind));
+}
+
+
 void
 test_subsume_1(Context& cxt)
 {
@@ -77,6 +280,52 @@ test_subsume_1(Context& cxt)
 
   bool b2 = subsumes(cxt, cons2, cons1);
   std::cout << cons2 << " ~< " << cons1 << " == " << b2 << '\n';
+
+  // Repeated queries are answered from the cache, whether the
+  // original result was positive or negative.
+  std::size_t hits = cxt.subsumptions.hits();
+  assert(subsumes(cxt, cons1, cons2) == b1);
+  assert(subsumes(cxt, cons2, cons1) == b2);
+  assert(cxt.subsumptions.hits() == hits + 2);
+}
+
+
+// The SAT engine must agree with the sequent engine.
+void
+test_subsume_sat(Context& cxt)
+{
+  Builder build(cxt);
+
+  Concept_decl& c = make_concept_1(cxt);
+  Type_parm& p1 = build.make_type_parameter("T");
+
+  Type& b = build.get_bool_type();
+  Type& t1 = build.get_typename_type(p1);
+
+  Expr& t = build.get_true();
+  Expr& f = build.get_false();
+  Expr& c1 = build.make_check(c, {&t1});
+  Expr& e1 = build.make_or(b, t, c1);
+  Expr& e2 = build.make_and(b, c1, f);
+  Expr& e3 = build.make_or(b, e2, f);
+
+  Cons& cons1 = normalize(cxt, e1);
+  Cons& cons2 = normalize(cxt, e2);
+  Cons& cons3 = normalize(cxt, e3);
+
+  Cons* cs[] {&cons1, &cons2, &cons3};
+  for (Cons* x : cs) {
+    for (Cons* y : cs) {
+      cxt.subsumptions.clear();
+      cxt.prover = sequent_engine;
+      bool r1 = subsumes(cxt, *x, *y);
+      cxt.subsumptions.clear();
+      cxt.prover = sat_engine;
+      bool r2 = subsumes(cxt, *x, *y);
+      assert(r1 == r2);
+    }
+  }
+  cxt.prover = sequent_engine;
 }
 
 
@@ -136,6 +385,14 @@ main(int argc, char* argv[])
 {
   Context cxt;
   test_canonical(cxt);
+  test_normalize(cxt);
+  test_expand(cxt);
+  test_satisfy(cxt);
+  test_satisfy_limit(cxt);
+  test_satisfy_compiled(cxt);
+  test_unique_ids(cxt);
+  test_admission_index(cxt);
   test_subsume_1(cxt);
   test_subsume_2(cxt);
+  test_subsume_sat(cxt);
 }
@@ -47,6 +47,43 @@ test_deduce_from_type(Context& cxt)
 }
 
 
+// Deduction from a call is memoized on the argument types.
+void
+test_deduce_from_call(Context& cxt)
+{
+  Builder build(cxt);
+
+  Type_parm& parm = build.make_type_parameter("T");
+  Type& t = build.get_typename_type(parm);
+  Object_parm& p = build.make_object_parm("a", t);
+  Decl& f = build.make_function("f", {&p}, t);
+  Template_decl& tmp = build.make_template({&parm}, f);
+
+  Expr_list args {&build.get_int(0)};
+  Substitution s1(tmp.parameters());
+  deduce_from_call(cxt, tmp, args, s1);
+  assert(s1.get_mapping(parm) == &build.get_int_type());
+
+  std::size_t hits = cxt.deductions.hits();
+  Expr_list args2 {&build.get_int(1)};
+  Substitution s2(tmp.parameters());
+  deduce_from_call(cxt, tmp, args2, s2);
+  assert(cxt.deductions.hits() == hits + 1);
+  assert(s2.get_mapping(parm) == &build.get_int_type());
+
+  // Failures are also memoized.
+  Expr_list none;
+  for (int i = 0; i < 2; ++i) {
+    Substitution s3(tmp.parameters());
+    try {
+      deduce_from_call(cxt, tmp, none, s3);
+      assert(false);
+    } catch (Deduction_error&) { }
+  }
+  assert(cxt.deductions.hits() == hits + 2);
+}
+
+
 
 
 int
@@ -54,4 +91,5 @@ main(int argc, char* argv[])
 {
   Context cxt;
   test_deduce_from_type(cxt);
+  test_deduce_from_call(cxt);
 }
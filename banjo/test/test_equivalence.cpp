@@ -25,8 +25,89 @@ test_types()
 }
 
 
+// Types built by the builder are unique within a context.
+void
+test_canonical_types(Context& cxt)
+{
+  Builder build(cxt);
+
+  Type& z1 = build.get_int_type();
+  Type& z2 = build.get_int_type();
+  assert(&z1 == &z2);
+  assert(z1.is_canonical());
+
+  Type& p1 = build.get_pointer_type(build.get_const_type(z1));
+  Type& p2 = build.get_pointer_type(build.get_const_type(z2));
+  assert(&p1 == &p2);
+  assert(&p1 != &build.get_pointer_type(z1));
+
+  Type& f1 = build.get_function_type(Type_list{&z1, &p1}, build.get_bool_type());
+  Type& f2 = build.get_function_type(Type_list{&z2, &p2}, build.get_bool_type());
+  assert(&f1 == &f2);
+
+  // A structurally equivalent type from outside the builder.
+  Type& z3 = *new Integer_type();
+  assert(!z3.is_canonical());
+  assert(is_equivalent(z1, z3));
+  assert(!is_equivalent(z1, build.get_uint_type()));
+
+  // Placeholder types are always distinct.
+  assert(!is_equivalent(build.get_auto_type(), build.get_auto_type()));
+}
+
+
+// Identifiers and small literals are unique within a context.
+void
+test_canonical_terms(Context& cxt)
+{
+  Builder build(cxt);
+
+  assert(&build.get_id("x") == &build.get_id("x"));
+  assert(&build.get_id("x") != &build.get_id("y"));
+
+  assert(&build.get_true() == &build.get_bool(true));
+  assert(&build.get_false() != &build.get_true());
+
+  assert(&build.get_int(1) == &build.get_int(1));
+  assert(&build.get_int(1) != &build.get_uint(1));
+  assert(&build.get_int(1000) != &build.get_int(1000));
+}
+
+
+// Kinds partition the class hierarchy, so isa and dyn_cast agree
+// with the dynamic type of each term.
+void
+test_kinds(Context& cxt)
+{
+  Builder build(cxt);
+
+  Type& t1 = build.get_int_type();
+  assert(kind_of(t1) == integer_type_kind);
+  assert(isa<Type>(t1));
+  assert(!isa<Expr>(t1));
+  assert(!isa<User_defined_type>(t1));
+
+  Expr& e1 = build.get_int(0);
+  assert(isa<Expr>(e1));
+  assert(isa<Integer_expr>(e1));
+  assert(!isa<Boolean_expr>(e1));
+  assert(dyn_cast<Integer_expr>(&e1) == &e1);
+  assert(dyn_cast<Boolean_expr>(&e1) == nullptr);
+
+  // Terms not created by the builder compute their kind on demand.
+  Boolean_type t2;
+  assert(kind_of(t2) == boolean_type_kind);
+  assert(isa<Boolean_type>(t2));
+}
+
+
 int
 main(int argc, char* argv[])
 {
+  Context cxt;
+
   test_types();
+  test_canonical_types(cxt);
+  test_canonical_terms(cxt);
+  test_kinds(cxt);
 }
@@ -0,0 +1,311 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "test.hpp"
+
+#include <banjo/evaluation.hpp>
+#include <banjo/bytecode.hpp>
+#include <banjo/declaration.hpp>
+#include <banjo/jit.hpp>
+
+#include <iostream>
+
+
+// Define f to return the expression e.
+void
+define(Builder& build, Function_decl& f, Expr& e)
+{
+  Stmt& ret = build.make_return_statement(e);
+  f.def = &build.make_function_definition(build.make_compound_statement({&ret}));
+}
+
+
+// Returns the value of e computed by the evaluator and checks that
+// compiled code produces the same value.
+Integer_value
+check(Context& cxt, Expr& e)
+{
+  Value v1 = evaluate(cxt, e);
+  Value v2 = execute(cxt, e);
+  assert(v1.is_integer() && v2.is_integer());
+  assert(v1.get_integer() == v2.get_integer());
+  return v1.get_integer();
+}
+
+
+// Checks that both the evaluator and compiled code fail to evaluate e.
+void
+check_error(Context& cxt, Expr& e)
+{
+  bool e1 = false;
+  bool e2 = false;
+  try { evaluate(cxt, e); } catch (Evaluation_error&) { e1 = true; }
+  try { execute(cxt, e); } catch (Evaluation_error&) { e2 = true; }
+  assert(e1 && e2);
+}
+
+
+void
+test_arithmetic(Context& cxt)
+{
+  Builder build(cxt);
+  Type& z = build.get_int_type();
+  Type& b = build.get_bool_type();
+
+  // poly(x) = x * x - x / 3 % 2 + -x
+  Object_parm& x = build.make_object_parm("x", z);
+  Function_decl& poly = build.make_function("poly", {&x}, z);
+  Expr& rx = build.make_reference(x);
+  define(build, poly,
+    build.make_add(z,
+      build.make_sub(z,
+        build.make_mul(z, rx, rx),
+        build.make_rem(z, build.make_div(z, rx, build.get_int(3)), build.get_int(2))),
+      build.make_neg(z, rx)));
+
+  for (int n : {0, 1, 7, -7, 100})
+    check(cxt, build.make_call(z, poly, {&build.get_int(n)}));
+  assert(check(cxt, build.make_call(z, poly, {&build.get_int(7)})) == 42);
+
+  // Relational operators.
+  Expr& one = build.get_int(1);
+  Expr& two = build.get_int(2);
+  assert(check(cxt, build.make_lt(b, one, two)) == 1);
+  assert(check(cxt, build.make_ge(b, one, two)) == 0);
+  assert(check(cxt, build.make_ne(b, one, two)) == 1);
+
+  // Division by zero.
+  check_error(cxt, build.make_div(z, one, build.get_int(0)));
+  check_error(cxt, build.make_rem(z, one, build.get_int(0)));
+}
+
+
+void
+test_recursion(Context& cxt)
+{
+  Builder build(cxt);
+  Type& z = build.get_int_type();
+  Type& b = build.get_bool_type();
+
+  // fib(n) = n < 2 || fib(n - 1) && fib(n - 2)
+  Object_parm& n = build.make_object_parm("n", z);
+  Function_decl& fib = build.make_function("fib", {&n}, b);
+  Expr& rn = build.make_reference(n);
+  Expr& n1 = build.make_sub(z, rn, build.get_int(1));
+  Expr& n2 = build.make_sub(z, rn, build.get_int(2));
+  define(build, fib,
+    build.make_or(b,
+      build.make_lt(b, rn, build.get_int(2)),
+      build.make_and(b, build.make_call(b, fib, {&n1}),
+                        build.make_call(b, fib, {&n2}))));
+
+  assert(check(cxt, build.make_call(b, fib, {&build.get_int(10)})) == 1);
+  assert(get_bytecode(cxt, fib));
+
+  // A function that does not return fails in both.
+  Function_decl& g = build.make_function("g", {}, z);
+  g.def = &build.make_function_definition(build.make_compound_statement({}));
+  check_error(cxt, build.make_call(z, g, {}));
+}
+
+
+// Check the assignment of slots to parameters and locals. The
+// slots of a nested block are reused by later blocks.
+void
+test_frame(Context& cxt)
+{
+  Builder build(cxt);
+  Type& z = build.get_int_type();
+
+  Object_parm& p = build.make_object_parm("p", z);
+  Variable_decl& a = build.make_variable("a", z);
+  Variable_decl& b = build.make_variable("b", z);
+  Variable_decl& c = build.make_variable("c", z);
+  Variable_decl& d = build.make_variable("d", z);
+  Stmt& s1 = build.make_compound_statement({&build.make_declaration_statement(b),
+                                            &build.make_declaration_statement(c)});
+  Stmt& s2 = build.make_compound_statement({&build.make_declaration_statement(d)});
+  Stmt& ret = build.make_return_statement(build.make_reference(p));
+  Stmt& body = build.make_compound_statement({&build.make_declaration_statement(a),
+                                              &s1, &s2, &ret});
+  Function_decl& f = build.make_function("f", {&p}, z);
+  f.def = &build.make_function_definition(body);
+
+  allocate_frame(f);
+  assert(p.slot == 0);
+  assert(a.slot == 1);
+  assert(b.slot == 2 && c.slot == 3);
+  assert(d.slot == 2);
+  assert(f.frame == 4);
+
+  // Objects are only accessible within a call.
+  bool err = false;
+  try { evaluate(cxt, build.make_reference(a)); } catch (Evaluation_error&) { err = true; }
+  assert(err);
+}
+
+
+// Check the memoization of calls to pure functions.
+void
+test_memo(Context& cxt)
+{
+  Builder build(cxt);
+  Type& z = build.get_int_type();
+  Type& b = build.get_bool_type();
+
+  // fib(n) = n < 2 || fib(n - 1) && fib(n - 2)
+  Object_parm& n = build.make_object_parm("n", z);
+  Function_decl& fib = build.make_function("fib", {&n}, b);
+  Expr& rn = build.make_reference(n);
+  Expr& n1 = build.make_sub(z, rn, build.get_int(1));
+  Expr& n2 = build.make_sub(z, rn, build.get_int(2));
+  define(build, fib,
+    build.make_or(b,
+      build.make_lt(b, rn, build.get_int(2)),
+      build.make_and(b, build.make_call(b, fib, {&n1}),
+                        build.make_call(b, fib, {&n2}))));
+  assert(is_pure(cxt, fib));
+
+  // Functions that refer to non-local objects are not pure, nor
+  // are their callers.
+  Variable_decl& v = build.make_variable("v", z);
+  Function_decl& g = build.make_function("g", {}, z);
+  define(build, g, build.make_reference(v));
+  Function_decl& h = build.make_function("h", {}, z);
+  define(build, h, build.make_call(z, g, {}));
+  assert(!is_pure(cxt, h));
+  assert(!is_pure(cxt, g));
+
+  // Calls are not memoized by default.
+  Expr& call = build.make_call(b, fib, {&build.get_int(20)});
+  assert(evaluate(cxt, call).get_integer() == 1);
+  assert(cxt.calls.size() == 0);
+
+  // Each distinct call is evaluated once.
+  cxt.calls.limit = 1024;
+  assert(evaluate(cxt, call).get_integer() == 1);
+  assert(cxt.calls.size() == 21);
+  std::size_t hits = cxt.calls.hits();
+  assert(hits > 0);
+  assert(evaluate(cxt, call).get_integer() == 1);
+  assert(cxt.calls.hits() == hits + 1);
+
+  // The table is bounded.
+  cxt.calls.limit = 4;
+  cxt.calls.results.clear();
+  assert(evaluate(cxt, call).get_integer() == 1);
+  assert(cxt.calls.size() <= 4);
+  assert(cxt.calls.flushes() > 0);
+  cxt.calls.limit = 0;
+}
+
+
+// Check that native code produces the same values as the evaluator.
+// Without the JIT, functions are never compiled.
+void
+test_jit(Context& cxt)
+{
+  Builder build(cxt);
+  Type& z = build.get_int_type();
+
+  // quot(a, b) = a / b + a % b
+  Object_parm& a = build.make_object_parm("a", z);
+  Object_parm& b = build.make_object_parm("b", z);
+  Function_decl& quot = build.make_function("quot", {&a, &b}, z);
+  Expr& ra = build.make_reference(a);
+  Expr& rb = build.make_reference(b);
+  define(build, quot,
+    build.make_add(z, build.make_div(z, ra, rb), build.make_rem(z, ra, rb)));
+
+  Expr& c1 = build.make_call(z, quot, {&build.get_int(17), &build.get_int(5)});
+  Expr& c2 = build.make_call(z, quot, {&build.get_int(1), &build.get_int(0)});
+  assert(check(cxt, c1) == 5);
+
+  cxt.jit.threshold = 1;
+  assert(evaluate(cxt, c1).get_integer() == 5);
+  check_error(cxt, c2);
+  if (jit_available()) {
+    assert(cxt.jit.compiled() == 1);
+    assert(cxt.jit.calls() == 2);
+  } else {
+    assert(cxt.jit.compiled() == 0);
+  }
+  cxt.jit.threshold = 0;
+}
+
+
+// Check that iterative evaluation agrees with the evaluator, and
+// that it handles deep recursion.
+void
+test_iterative(Context& cxt)
+{
+  Builder build(cxt);
+  Type& z = build.get_int_type();
+  Type& b = build.get_bool_type();
+
+  // down(n) = n == 0 || down(n - 1)
+  Object_parm& n = build.make_object_parm("n", z);
+  Function_decl& down = build.make_function("down", {&n}, b);
+  Expr& rn = build.make_reference(n);
+  Expr& n1 = build.make_sub(z, rn, build.get_int(1));
+  define(build, down,
+    build.make_or(b,
+      build.make_eq(b, rn, build.get_int(0)),
+      build.make_call(b, down, {&n1})));
+
+  // poly(x) = -x * 3 / 2 % 5 != x && !(x < 0)
+  Object_parm& x = build.make_object_parm("x", z);
+  Function_decl& poly = build.make_function("poly", {&x}, b);
+  Expr& rx = build.make_reference(x);
+  Expr& lhs = build.make_rem(z,
+    build.make_div(z, build.make_mul(z, build.make_neg(z, rx), build.get_int(3)), build.get_int(2)),
+    build.get_int(5));
+  define(build, poly,
+    build.make_and(b,
+      build.make_ne(b, lhs, rx),
+      build.make_not(b, build.make_lt(b, rx, build.get_int(0)))));
+  for (int k : {-3, 0, 4, 9}) {
+    Expr& c = build.make_call(b, poly, {&build.get_int(k)});
+    assert(evaluate(cxt, c).get_integer() == evaluate_iteratively(cxt, c).get_integer());
+  }
+
+  // Deep recursion does not consume the native stack.
+  Expr& deep = build.make_call(b, down, {&build.get_int(100000)});
+  assert(evaluate_iteratively(cxt, deep).get_integer() == 1);
+
+  // Exceeding a limit is an evaluation error.
+  Iterative_evaluator e1(cxt);
+  e1.depth_limit = 1000;
+  bool err = false;
+  try { e1(deep); } catch (Evaluation_error&) { err = true; }
+  assert(err);
+
+  Iterative_evaluator e2(cxt);
+  e2.step_limit = 1000;
+  err = false;
+  try { e2(deep); } catch (Evaluation_error&) { err = true; }
+  assert(err);
+
+  // The evaluator can be reused after an error.
+  Expr& shallow = build.make_call(b, down, {&build.get_int(10)});
+  assert(e2(shallow).get_integer() == 1);
+
+  // Division by zero is reported as usual.
+  err = false;
+  try { evaluate_iteratively(cxt, build.make_div(z, build.get_int(1), build.get_int(0))); }
+  catch (Evaluation_error&) { err = true; }
+  assert(err);
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  Context cxt;
+  test_arithmetic(cxt);
+  test_recursion(cxt);
+  test_frame(cxt);
+  test_memo(cxt);
+  test_jit(cxt);
+  test_iterative(cxt);
+}
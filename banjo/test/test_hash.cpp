@@ -5,6 +5,7 @@
 
 #include <banjo/hash.hpp>
 
+#include <chrono>
 #include <iostream>
 #include <unordered_set>
 
@@ -37,8 +38,58 @@ test_types()
 }
 
 
+// Build a left-nested chain of n conjunctions. The nodes are not
+// uniqued, so nothing is hashed during construction.
+Cons&
+make_chain(Context& cxt, int n)
+{
+  Builder build(cxt);
+  Cons* c = &build.get_predicate_constraint(build.get_true());
+  for (int i = 0; i < n; ++i) {
+    Cons& p = build.get_predicate_constraint(build.get_int(i % 200));
+    c = &build.make<Conjunction_cons>(*c, p);
+  }
+  return *c;
+}
+
+
+// Hash values are cached, so only the first hash of a deep constraint
+// visits every node. Subsequent hashes are constant time.
+void
+test_deep_constraints(Context& cxt)
+{
+  using Clock = std::chrono::steady_clock;
+  using Micro = std::chrono::duration<double, std::micro>;
+
+  int const depth = 2000;
+  int const reps = 10000;
+
+  Cons& c1 = make_chain(cxt, depth);
+  Cons& c2 = make_chain(cxt, depth);
+
+  auto t0 = Clock::now();
+  std::size_t h1 = hash_value(c1);
+  auto t1 = Clock::now();
+  std::size_t h2 = 0;
+  for (int i = 0; i < reps; ++i)
+    h2 ^= hash_value(c1);
+  auto t2 = Clock::now();
+
+  // Equivalent chains have equal hashes.
+  assert(h1 == hash_value(c2));
+  assert(h2 == (reps % 2 ? h1 : 0));
+
+  std::cout << "--- hash of " << depth << " conjunctions ---\n";
+  std::cout << "first:  " << Micro(t1 - t0).count() << " us\n";
+  std::cout << "cached: " << Micro(t2 - t1).count() / reps << " us\n";
+}
+
+
 int
 main(int argc, char* argv[])
 {
+  Context cxt;
+
   test_types();
+  test_deep_constraints(cxt);
 }
@@ -4,6 +4,7 @@
 #include "test.hpp"
 
 #include <banjo/substitution.hpp>
+#include <banjo/constraint.hpp>
 
 #include <iostream>
 
@@ -69,6 +70,110 @@ test_subst_decl(Context& cxt)
 }
 
 
+// Mappings are found by identity even when parameters share an
+// index, and are iterated in the order of their indexes.
+void
+test_subst_mapping(Context& cxt)
+{
+  Builder build(cxt);
+
+  Type_parm& t1 = build.make_type_parameter("T1");
+  Type_parm& t2 = build.make_type_parameter("T2");
+  Type_parm& t3 = build.make_type_parameter("T3");
+  Type& a1 = build.get_int_type();
+  Type& a2 = build.get_bool_type();
+
+  Decl_list parms {&t1, &t2, &t3};
+  Substitution sub(parms);
+  assert(sub.size() == 3);
+  assert(sub.is_incomplete());
+  sub.map_to(t3, a2);
+  sub.map_to(t1, a1);
+  assert(sub.get_mapping(t1) == &a1);
+  assert(sub.get_mapping(t2) == nullptr);
+  assert(sub.get_mapping(t3) == &a2);
+  sub.map_to(t2, a1);
+  assert(!sub.is_incomplete());
+
+  Decl_list ps = sub.parameters();
+  auto iter = ps.begin();
+  assert(&*iter++ == &t1);
+  assert(&*iter++ == &t2);
+  assert(&*iter++ == &t3);
+
+  // A distinct parameter with the same index as t1.
+  Type_parm& u = build.make<Type_parm>(t1.index(), build.get_id("U"));
+  assert(!sub.has_mapping(u));
+  sub.map_to(u, a2);
+  assert(sub.get_mapping(u) == &a2);
+  assert(sub.get_mapping(t1) == &a1);
+  assert(sub.size() == 4);
+}
+
+// Dependence is computed when terms are built, and substitution
+// leaves terms without parameters unchanged.
+void
+test_subst_dependence(Context& cxt)
+{
+  Builder build(cxt);
+
+  Decl& parm = build.make_type_parameter("T");
+  Type& arg = build.get_int_type();
+  Substitution sub;
+  sub.map_to(parm, arg);
+
+  Type& t = build.get_typename_type(parm);
+  Type& p = build.get_pointer_type(t);
+  Type& q = build.get_pointer_type(arg);
+  assert(t.is_dependent() && p.is_dependent());
+  assert(!q.is_dependent() && !q.contains_parameters());
+  assert(&substitute(cxt, q, sub) == &q);
+  assert(&substitute(cxt, p, sub) == &build.get_pointer_type(arg));
+
+  Expr& z = build.get_int(0);
+  Expr& e = build.make_eq(build.get_bool_type(), z, z);
+  assert(!e.is_type_dependent() && !e.is_value_dependent());
+  assert(&substitute(cxt, e, sub) == &e);
+
+  Concept_decl& c = build.make_concept("C", {&parm}, build.get_true());
+  Expr& chk = build.make_check(c, {&t});
+  assert(!chk.is_type_dependent());
+  assert(chk.is_value_dependent() && chk.contains_parameters());
+}
+
+
+// An expression admitted by a conversion constraint has the dependent
+// type of that constraint, and substitution resolves the conversion.
+void
+test_subst_admission(Context& cxt)
+{
+  Builder build(cxt);
+  Enter_scope scope(cxt, cxt.global_namespace());
+
+  Decl& parm = build.make_type_parameter("T");
+  Type& arg = build.get_int_type();
+  Substitution sub;
+  sub.map_to(parm, arg);
+
+  // a == a -> T
+  Type& t = build.get_typename_type(parm);
+  Type& b = build.get_bool_type();
+  Object_parm& a = build.make_object_parm("a", t);
+  Expr& ra = build.make_reference(a);
+  Cons& c = build.get_conversion_constraint(build.make_eq(b, ra, ra), t);
+
+  Expr& z = build.get_int(0);
+  Expr& e = build.make_eq(b, z, z);
+  Expr* conv = admit_conversion(cxt, c, e, t);
+  assert(conv && conv != &e);
+  assert(conv->is_type_dependent() && conv->contains_parameters());
+
+  Expr& s = substitute(cxt, *conv, sub);
+  assert(&s != conv);
+  assert(is_equivalent(s.type(), arg));
+  assert(!s.is_type_dependent());
+}
+
 
 int
 main(int argc, char* argv[])
@@ -76,4 +181,7 @@ main(int argc, char* argv[])
   Context cxt;
   test_subst_type(cxt);
   test_subst_decl(cxt);
+  test_subst_mapping(cxt);
+  test_subst_dependence(cxt);
+  test_subst_admission(cxt);
 }
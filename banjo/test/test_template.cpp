@@ -5,6 +5,9 @@
 
 #include <banjo/template.hpp>
 #include <banjo/substitution.hpp>
+#include <banjo/instantiation.hpp>
+#include <banjo/evaluation.hpp>
+#include <banjo/conversion.hpp>
 
 #include <iostream>
 
@@ -64,6 +67,68 @@ test_specialize(Context& cxt)
   std::cout << tv1 << "\n   vvvv\n";
   Decl& ts1 = specialize_template(cxt, tv1, args);
   std::cout << ts1 << '\n';
+
+  // Specializations are cached by their arguments.
+  Term_list args2 {&build.get_int_type()};
+  Decl& ts2 = specialize_template(cxt, tv1, args2);
+  assert(&ts1 == &ts2);
+  assert(tv1.specializations().size() == 1);
+  assert(tv1.specializations().hits() == 1);
+
+  Term_list args3 {&build.get_bool_type()};
+  Decl& ts3 = specialize_template(cxt, tv1, args3);
+  assert(&ts1 != &ts3);
+  assert(tv1.specializations().size() == 2);
+}
+
+
+// Definitions of specializations are instantiated once, when needed.
+// The instantiated definition refers to the specialization's own
+// parameters and local variables, and to the template arguments.
+void
+test_instantiate(Context& cxt)
+{
+  Builder build(cxt);
+  Enter_scope scope(cxt, cxt.global_namespace());
+
+  // template<typename T, int N>
+  // bool g(int x) { int y = x; return y == N; }
+  Type& z = build.get_int_type();
+  Type& b = build.get_bool_type();
+  Type_parm& parm = build.make_type_parameter("T");
+  Value_parm& n = build.make_value_parm("N", z);
+  Object_parm& x = build.make_object_parm("x", z);
+  Expr& init = build.make_copy_init(z, build.make_reference(x));
+  Variable_decl& y = build.make_variable("y", z, init);
+  Stmt& decl = build.make_declaration_statement(y);
+  Expr& ry = standard_conversion(build.make_reference(y), z);
+  Stmt& ret = build.make_return_statement(build.make_eq(b, ry, build.make_reference(n)));
+  Function_decl& f = build.make_function("g", {&x}, b);
+  f.def = &build.make_function_definition(build.make_compound_statement({&decl, &ret}));
+  Template_decl& tmp = build.make_template({&parm, &n}, f);
+
+  Term_list args {&build.get_bool_type(), &build.get_int(3)};
+  Function_decl& spec = cast<Function_decl>(specialize_template(cxt, tmp, args));
+  assert(!spec.is_definition());
+
+  std::size_t done = cxt.instantiations.instantiated();
+  require_definition(cxt, spec);
+  require_definition(cxt, spec);
+  assert(cxt.instantiations.pending() == 1);
+  assert(instantiate_pending(cxt) == 1);
+  assert(spec.is_definition());
+  assert(cxt.instantiations.instantiated() == done + 1);
+
+  // Later requests have no effect.
+  require_definition(cxt, spec);
+  assert(cxt.instantiations.empty());
+
+  Expr& c1 = build.make_call(b, spec, {&build.get_int(3)});
+  Expr& c2 = build.make_call(b, spec, {&build.get_int(4)});
+  assert(evaluate(cxt, c1).get_integer() == 1);
+  assert(evaluate(cxt, c2).get_integer() == 0);
+  assert(evaluate_iteratively(cxt, c1).get_integer() == 1);
+  assert(evaluate_iteratively(cxt, c2).get_integer() == 0);
 }
 
 
@@ -96,6 +161,59 @@ test_synthesis(Context& cxt)
 }
 
 
+// Ordering results are memoized, and the most specialized member of
+// an overload set agrees with pairwise ordering.
+void
+test_ordering(Context& cxt)
+{
+  Builder build(cxt);
+
+  Type_parm& tp1 = build.make_type_parameter("T");
+  Type& t1 = build.get_typename_type(tp1);
+  Type& p1 = build.get_pointer_type(t1);
+
+  Object_parm& a1 = build.make_object_parm("a", t1);
+  Object_parm& a2 = build.make_object_parm("b", p1);
+
+  Decl& f1 = build.make_function("g", {&a1}, t1);
+  Template_decl& tmp1 = build.make_template({&tp1}, f1);
+  Decl& f2 = build.make_function("g", {&a2}, t1);
+  Template_decl& tmp2 = build.make_template({&tp1}, f2);
+
+  // g(T*) is more specialized than g(T), and the result is memoized.
+  bool lt = is_more_specialized(cxt, tmp2, tmp1);
+  assert(lt);
+  assert(cxt.orderings.find({&tmp2, &tmp1}));
+  assert(cxt.orderings.find({&tmp1, &tmp2}));
+  assert(is_more_specialized(cxt, tmp2, tmp1) == lt);
+  assert(!is_more_specialized(cxt, tmp1, tmp2));
+
+  Overload_set ovl(tmp1);
+  ovl.insert(tmp2);
+  Decl_list cands {&tmp1, &tmp2};
+  Decl* best = most_specialized(cxt, ovl, cands);
+  assert(ovl.order);
+  assert(best == &tmp2);
+
+  // Inserting into the set invalidates its order.
+  Object_parm& a3 = build.make_object_parm("c", t1);
+  Object_parm& a4 = build.make_object_parm("d", t1);
+  Decl& f3 = build.make_function("g", {&a3, &a4}, t1);
+  Template_decl& tmp3 = build.make_template({&tp1}, f3);
+  ovl.insert(tmp3);
+  assert(!ovl.order);
+
+  // Templates with different numbers of parameters are unordered.
+  Decl_list all {&tmp1, &tmp2, &tmp3};
+  assert(!most_specialized(cxt, ovl, all));
+  assert(ovl.order);
+
+  // A single candidate is trivially the most specialized.
+  Decl_list one {&tmp1};
+  assert(most_specialized(cxt, ovl, one) == &tmp1);
+}
+
+
 int
 main(int argc, char* argv[])
 {
@@ -103,5 +221,7 @@ main(int argc, char* argv[])
 
   test_basics(cxt);
   test_specialize(cxt);
+  test_instantiate(cxt);
   test_synthesis(cxt);
+  test_ordering(cxt);
 }